@@ -0,0 +1,212 @@
+#pragma once
+
+#include "packetwrappers/eventcolumns.h"
+
+#include <QObject>
+
+#include <any>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Columnar batch delivery of PSD and PHA events.
+ *
+ * The alternative to the EventData batch callback for vectorized analysis:
+ * events are gathered per device and packet type into PsdColumns and
+ * PhaColumns and handed over a batch at a time. A batch is published when
+ * it holds batchEvents events, when its oldest event has waited maxLatency
+ * by the time it is next checked, or on flush().
+ *
+ * Batches come from two sources. ReceivePipeline::setColumnSink() makes a
+ * pipeline decode its PSD and PHA packets with PacketParser::parseInto()
+ * straight from the receive slab into the open batch of their type, on the
+ * framing thread and in stream order; nothing is emitted per packet, and
+ * the pipeline publishes from that thread only, also when it stops.
+ * attach() and deliver() instead gather the packets a PacketBuffer has
+ * already parsed, for buffers that emit as before. attach() connects
+ * through a context object owned by the sink, so destroying the sink
+ * disconnects it; a buffer that is parsing on another thread must be
+ * disconnected (or stopped) before the sink goes away.
+ *
+ * Callbacks run on the publishing thread, one at a time; the columns are
+ * only valid during the call and are reused afterwards, so consumers copy
+ * what they keep. Callbacks must not call back into the sink.
+ */
+
+struct EventColumnsPolicy
+{
+    size_t batchEvents{4096};
+    std::chrono::nanoseconds maxLatency{std::chrono::milliseconds(20)};
+};
+
+// An open batch and the time its first event arrived.
+template <typename Columns> struct ColumnBatch
+{
+    Columns columns;
+    std::chrono::steady_clock::time_point opened;
+
+    template <typename Packet, typename Source> void append(const Source &source)
+    {
+        if (columns.empty())
+            opened = std::chrono::steady_clock::now();
+
+        columns.template append<Packet>(source);
+    }
+
+    bool isFull(const EventColumnsPolicy &policy) const
+    {
+        return columns.size() >= policy.batchEvents;
+    }
+
+    bool isDue(const EventColumnsPolicy &policy) const
+    {
+        return isFull(policy) || (!columns.empty() && std::chrono::steady_clock::now() - opened >= policy.maxLatency);
+    }
+};
+
+class EventColumnsSink final
+{
+  public:
+    using PsdBatchCallback = std::function<void(const PsdColumns &)>;
+    using PhaBatchCallback = std::function<void(const PhaColumns &)>;
+
+    explicit EventColumnsSink(const EventColumnsPolicy &policy = {}) : m_policy(policy)
+    {
+    }
+
+    EventColumnsSink(const EventColumnsSink &) = delete;
+    EventColumnsSink &operator=(const EventColumnsSink &) = delete;
+
+    const EventColumnsPolicy &policy() const
+    {
+        return m_policy;
+    }
+
+    void setPsdBatchCallback(PsdBatchCallback callback)
+    {
+        std::lock_guard lock(m_callbackMutex);
+        m_psdCallback = std::move(callback);
+    }
+
+    void setPhaBatchCallback(PhaBatchCallback callback)
+    {
+        std::lock_guard lock(m_callbackMutex);
+        m_phaCallback = std::move(callback);
+    }
+
+    // Hands a batch to its callback and clears it, keeping its capacity; for the batches' owner.
+    void publish(PsdColumns &columns)
+    {
+        if (columns.empty())
+            return;
+
+        std::lock_guard lock(m_callbackMutex);
+        if (m_psdCallback)
+            m_psdCallback(columns);
+
+        columns.clear();
+    }
+
+    void publish(PhaColumns &columns)
+    {
+        if (columns.empty())
+            return;
+
+        std::lock_guard lock(m_callbackMutex);
+        if (m_phaCallback)
+            m_phaCallback(columns);
+
+        columns.clear();
+    }
+
+    /*
+     * Gathers from the packetParsed() signal of a PacketBuffer; a template so
+     * that the parser workers can include this header. The connection dies
+     * with the sink; disconnect it first to stop a buffer that keeps running.
+     */
+    template <typename Buffer> QMetaObject::Connection attach(Buffer *buffer)
+    {
+        return QObject::connect(buffer, &Buffer::packetParsed, m_context.get(), [this](const std::vector<std::any> &packets) { deliver(packets); },
+                                Qt::DirectConnection);
+    }
+
+    // Gathers the PSD and PHA packets of a parsed batch; other packet types are ignored.
+    void deliver(const std::vector<std::any> &packets)
+    {
+        std::lock_guard lock(m_batchMutex);
+
+        for (const auto &packet : packets)
+        {
+            if (const auto *psd = std::any_cast<PsdNetworkPacket>(&packet))
+                gather(m_psdBatches, *psd);
+            else if (const auto *psdV2 = std::any_cast<PsdNetworkPacketV2>(&packet))
+                gather(m_psdBatches, *psdV2);
+            else if (const auto *pha = std::any_cast<PhaNetworkPacket>(&packet))
+                gather(m_phaBatches, *pha);
+        }
+
+        publishDue(m_psdBatches);
+        publishDue(m_phaBatches);
+    }
+
+    // Publishes the partial batches gathered by deliver(); pipelines publish theirs when they stop.
+    void flush()
+    {
+        std::lock_guard lock(m_batchMutex);
+
+        for (auto &[key, batch] : m_psdBatches)
+            publish(batch.columns);
+
+        for (auto &[key, batch] : m_phaBatches)
+            publish(batch.columns);
+    }
+
+  private:
+    using BatchKey = std::pair<quint32, EventPacketType>;
+
+    template <typename Columns, typename Packet> void gather(std::map<BatchKey, ColumnBatch<Columns>> &batches, const Packet &packet)
+    {
+        auto &batch = batches[{packet.deviceId, packet.packetType}];
+        if (batch.columns.empty())
+        {
+            batch.columns.deviceId = packet.deviceId;
+            batch.columns.packetType = packet.packetType;
+        }
+
+        batch.template append<Packet>(packet);
+        if (batch.isFull(m_policy))
+            publish(batch.columns);
+    }
+
+    template <typename Columns> void publishDue(std::map<BatchKey, ColumnBatch<Columns>> &batches)
+    {
+        for (auto &[key, batch] : batches)
+        {
+            if (batch.isDue(m_policy))
+                publish(batch.columns);
+        }
+    }
+
+    const EventColumnsPolicy m_policy;
+
+    std::mutex m_callbackMutex;
+    PsdBatchCallback m_psdCallback;
+    PhaBatchCallback m_phaCallback;
+
+    std::mutex m_batchMutex;
+    std::map<BatchKey, ColumnBatch<PsdColumns>> m_psdBatches;
+    std::map<BatchKey, ColumnBatch<PhaColumns>> m_phaBatches;
+
+    // Declared last so that attached buffers are disconnected before the batches go away.
+    std::unique_ptr<QObject> m_context = std::make_unique<QObject>();
+};
+
+} // namespace network
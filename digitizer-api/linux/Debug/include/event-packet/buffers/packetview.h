@@ -0,0 +1,135 @@
+#pragma once
+
+#include "payloadpool.h"
+#include "packets/eventpackettype.h"
+#include "packets/littleendianreader.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSharedPointer>
+#include <QtEndian>
+
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Lazily decoded view of a variable-length packet (waveform, spectrum).
+ *
+ * Keeps the shared receive buffer alive and refers to the packet by offset.
+ * Construct it through PacketParser<T>::parsePacketView(), which validates
+ * device ID, packet type and checksum up front; the header accessors read
+ * straight from the buffer and the sample array is only decoded when
+ * samples() or packet() is called; samples(pool) decodes into recycled
+ * memory of the device's PayloadPool.
+ */
+
+template <typename T> class PacketView final
+{
+  public:
+    using SampleType = typename decltype(T::array)::value_type;
+
+    PacketView() = default;
+
+    PacketView(QSharedPointer<QByteArray> buffer, int offset, int length) : m_buffer(std::move(buffer)), m_offset(offset), m_length(length)
+    {
+    }
+
+    bool isNull() const
+    {
+        return m_buffer.isNull();
+    }
+
+    const QSharedPointer<QByteArray> &buffer() const
+    {
+        return m_buffer;
+    }
+
+    int offset() const
+    {
+        return m_offset;
+    }
+
+    int size() const
+    {
+        return m_length;
+    }
+
+    QByteArrayView bytes() const
+    {
+        return QByteArrayView(m_buffer->constData() + m_offset, m_length);
+    }
+
+    quint32 deviceId() const
+    {
+        return read<quint32>(T::Layout::template offsetOf<&T::deviceId>());
+    }
+
+    EventPacketType packetType() const
+    {
+        return static_cast<EventPacketType>(read<quint8>(T::Layout::template offsetOf<&T::packetType>()));
+    }
+
+    quint8 flags() const
+    {
+        return read<quint8>(T::Layout::template offsetOf<&T::flags>());
+    }
+
+    quint16 channelId() const
+    {
+        return read<quint16>(T::Layout::template offsetOf<&T::channelId>());
+    }
+
+    quint64 rtc() const
+    {
+        return read<quint64>(T::Layout::template offsetOf<&T::rtc>());
+    }
+
+    quint32 sampleCount() const
+    {
+        return read<quint32>(T::arrayLengthOffset());
+    }
+
+    QByteArrayView rawSamples() const
+    {
+        return bytes().sliced(T::fixedPartSize(), static_cast<qsizetype>(sampleCount()) * sizeof(SampleType));
+    }
+
+    std::vector<SampleType> samples() const
+    {
+        std::vector<SampleType> values;
+        LittleEndianReader reader(rawSamples());
+        readArray(reader, values, sampleCount());
+        return values;
+    }
+
+    PooledArray<SampleType> samples(PayloadPool &pool) const
+    {
+        auto values = pool.makeArray<SampleType>(0);
+        LittleEndianReader reader(rawSamples());
+        readArray(reader, *values, sampleCount());
+        return values;
+    }
+
+    T packet() const
+    {
+        LittleEndianReader reader(bytes());
+
+        T decoded{};
+        decoded.deserialize(reader);
+        return decoded;
+    }
+
+  private:
+    template <typename U> U read(quint32 offset) const
+    {
+        return qFromLittleEndian<U>(m_buffer->constData() + m_offset + offset);
+    }
+
+    QSharedPointer<QByteArray> m_buffer;
+    int m_offset{};
+    int m_length{};
+};
+
+} // namespace network
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "eventerror.h"
+#include "packets/eventpackettype.h"
+
+#include <QByteArrayView>
+#include <QDebug>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Process-wide parse error accounting.
+ *
+ * Every rejected packet bumps an atomic counter per device, EventPacketType
+ * and EventError; counters are read through errorCount() and snapshot().
+ * device() finds a device's counters in a fixed open-addressing table
+ * without locking; only its first call for a device, and lookups once the
+ * table is full, take the registry mutex.
+ * Hex dumps of rejected packets are sampled: at most hexDumpsPerSecond dumps
+ * of at most hexDumpBytes bytes each are logged, the rest only counted, so a
+ * corrupted stream costs counters instead of log volume.
+ */
+
+struct ParseErrorCount
+{
+    quint32 deviceId{};
+    EventPacketType packetType{};
+    EventError error{};
+    quint64 count{};
+};
+
+class ParseDiagnostics final
+{
+  public:
+    static constexpr size_t packetTypeCount = 256;
+    static constexpr size_t errorTypeCount = static_cast<size_t>(EventError::RtcMismatch) + 1;
+
+    class DeviceCounters final
+    {
+      public:
+        void increment(EventPacketType type, EventError error)
+        {
+            m_counters[index(type, error)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        quint64 count(EventPacketType type, EventError error) const
+        {
+            return m_counters[index(type, error)].load(std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            for (auto &counter : m_counters)
+                counter.store(0, std::memory_order_relaxed);
+        }
+
+      private:
+        static size_t index(EventPacketType type, EventError error)
+        {
+            return static_cast<size_t>(type) * errorTypeCount + static_cast<size_t>(error);
+        }
+
+        std::array<std::atomic<quint64>, packetTypeCount * errorTypeCount> m_counters{};
+    };
+
+    static ParseDiagnostics &instance()
+    {
+        static ParseDiagnostics diagnostics;
+        return diagnostics;
+    }
+
+    DeviceCounters &device(quint32 deviceId)
+    {
+        for (size_t probe = 0; probe < tableSize; ++probe)
+        {
+            const auto &slot = m_table[(deviceId + probe) % tableSize];
+            const auto key = slot.key.load(std::memory_order_acquire);
+            if (key == emptyKey)
+                break;
+
+            if (key == deviceId)
+                return *slot.counters.load(std::memory_order_relaxed);
+        }
+
+        return addDevice(deviceId);
+    }
+
+    quint64 errorCount(quint32 deviceId, EventPacketType type, EventError error) const
+    {
+        std::lock_guard lock(m_devicesMutex);
+
+        const auto it = m_devices.find(deviceId);
+        return it == m_devices.end() ? 0 : it->second->count(type, error);
+    }
+
+    std::vector<ParseErrorCount> snapshot() const
+    {
+        std::lock_guard lock(m_devicesMutex);
+
+        std::vector<ParseErrorCount> result;
+        for (const auto &[deviceId, counters] : m_devices)
+        {
+            for (size_t type = 0; type < packetTypeCount; ++type)
+            {
+                for (size_t error = 0; error < errorTypeCount; ++error)
+                {
+                    const auto count = counters->count(static_cast<EventPacketType>(type), static_cast<EventError>(error));
+                    if (count != 0)
+                        result.push_back({deviceId, static_cast<EventPacketType>(type), static_cast<EventError>(error), count});
+                }
+            }
+        }
+
+        return result;
+    }
+
+    void reset()
+    {
+        std::lock_guard lock(m_devicesMutex);
+
+        for (auto &[deviceId, counters] : m_devices)
+            counters->reset();
+    }
+
+    void setHexDumpBudget(int dumpsPerSecond, int maxBytesPerDump)
+    {
+        m_hexDumpsPerSecond.store(std::max(dumpsPerSecond, 0), std::memory_order_relaxed);
+        m_hexDumpBytes.store(std::max(maxBytesPerDump, 0), std::memory_order_relaxed);
+    }
+
+    void record(DeviceCounters &counters, quint32 deviceId, EventPacketType type, EventError error, QByteArrayView packet)
+    {
+        counters.increment(type, error);
+
+        if (error == EventError::NotEnoughBytes || !tryAcquireHexDump())
+            return;
+
+        const auto dumpBytes = std::min<qsizetype>(packet.size(), m_hexDumpBytes.load(std::memory_order_relaxed));
+        const auto suppressed = m_suppressedDumps.exchange(0, std::memory_order_relaxed);
+
+        qWarning() << "Packet rejected. Device ID:" << deviceId << "Packet type:" << static_cast<int>(type) << "Error:" << static_cast<int>(error)
+                   << "Size:" << packet.size() << "Suppressed dumps:" << suppressed << "Packet array:" << packet.first(dumpBytes).toByteArray().toHex();
+    }
+
+  private:
+    static constexpr size_t tableSize = 256;
+    static constexpr quint64 emptyKey = ~quint64{};
+
+    // Slots are only ever filled, under m_devicesMutex; counters is stored before key publishes it.
+    struct TableSlot
+    {
+        std::atomic<quint64> key{emptyKey};
+        std::atomic<DeviceCounters *> counters{};
+    };
+
+    ParseDiagnostics() = default;
+
+    DeviceCounters &addDevice(quint32 deviceId)
+    {
+        std::lock_guard lock(m_devicesMutex);
+
+        auto &counters = m_devices[deviceId];
+        if (counters)
+            return *counters;
+
+        counters = std::make_unique<DeviceCounters>();
+        for (size_t probe = 0; probe < tableSize; ++probe)
+        {
+            auto &slot = m_table[(deviceId + probe) % tableSize];
+            if (slot.key.load(std::memory_order_relaxed) != emptyKey)
+                continue;
+
+            slot.counters.store(counters.get(), std::memory_order_relaxed);
+            slot.key.store(deviceId, std::memory_order_release);
+            break;
+        }
+
+        return *counters;
+    }
+
+    bool tryAcquireHexDump()
+    {
+        const auto budget = m_hexDumpsPerSecond.load(std::memory_order_relaxed);
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        auto window = m_dumpWindow.load(std::memory_order_relaxed);
+        if (window != now && m_dumpWindow.compare_exchange_strong(window, now, std::memory_order_relaxed))
+            m_dumpsInWindow.store(0, std::memory_order_relaxed);
+
+        if (m_dumpsInWindow.fetch_add(1, std::memory_order_relaxed) < budget)
+            return true;
+
+        m_suppressedDumps.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    mutable std::mutex m_devicesMutex;
+    std::map<quint32, std::unique_ptr<DeviceCounters>> m_devices;
+    std::array<TableSlot, tableSize> m_table{};
+
+    std::atomic<int> m_hexDumpsPerSecond{10};
+    std::atomic<int> m_hexDumpBytes{256};
+    std::atomic<qint64> m_dumpWindow{};
+    std::atomic<int> m_dumpsInWindow{};
+    std::atomic<quint64> m_suppressedDumps{};
+};
+
+} // namespace network
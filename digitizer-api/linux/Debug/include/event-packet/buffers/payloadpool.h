@@ -0,0 +1,244 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Per-device recycling pools for event payloads.
+ *
+ * Waveforms, spectra and the objects that carry them are allocated and
+ * freed at the event rate; through the global heap that costs malloc/free
+ * on every event and fragments the heap over long runs. A PayloadPool is a
+ * std::pmr memory resource with size-class free lists (a
+ * synchronized_pool_resource): freed blocks go back to the list of their
+ * size and are handed out again, so a steady acquisition stops asking the
+ * heap for memory once the lists are warm. Blocks above
+ * largestPooledBlock go straight to the heap.
+ *
+ * makeArray() returns a reference-counted sample array whose control
+ * block, vector and elements all come from the pool. The array keeps the
+ * pool alive, and its memory returns to the pool when the last reference,
+ * typically held by the delivered events, is dropped.
+ *
+ * The value types (eventvalue.h) take their waveform and spectrum samples
+ * from here when converted with a pool, from PacketBuffer's std::any
+ * packets or from ReceivePipeline's NetworkPackets alike; PacketView
+ * decodes into it straight from the receive buffer.
+ *
+ * Pools are created per device by PayloadPools, which also reports them.
+ * upstreamBytes staying flat while allocations grow means the pool
+ * recycles.
+ */
+
+struct PayloadPoolPolicy
+{
+    bool enabled{true};
+    size_t largestPooledBlock{256 * 1024};
+    size_t maxBlocksPerChunk{64};
+};
+
+struct PayloadPoolStats
+{
+    quint32 deviceId{};
+    quint64 allocations{};
+    quint64 bytesInUse{};
+    quint64 highWaterBytes{};
+    quint64 upstreamBytes{}; // held from the heap, pooled or not
+};
+
+template <typename T> using PooledArray = std::shared_ptr<const std::pmr::vector<T>>;
+
+class PayloadPool final : public std::pmr::memory_resource, public std::enable_shared_from_this<PayloadPool>
+{
+    // Counts what the pool holds from the heap.
+    class UpstreamResource final : public std::pmr::memory_resource
+    {
+      public:
+        quint64 bytes() const
+        {
+            return m_bytes.load(std::memory_order_relaxed);
+        }
+
+      private:
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            auto *memory = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            return memory;
+        }
+
+        void do_deallocate(void *memory, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+            m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        std::atomic<quint64> m_bytes{};
+    };
+
+    // Allocator of the control blocks; it keeps the pool alive until the last block is returned.
+    template <typename T> struct OwningAllocator
+    {
+        using value_type = T;
+
+        explicit OwningAllocator(std::shared_ptr<PayloadPool> owner) : pool(std::move(owner))
+        {
+        }
+
+        template <typename U> OwningAllocator(const OwningAllocator<U> &other) : pool(other.pool)
+        {
+        }
+
+        T *allocate(size_t count)
+        {
+            return static_cast<T *>(pool->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *memory, size_t count)
+        {
+            pool->deallocate(memory, count * sizeof(T), alignof(T));
+        }
+
+        template <typename U> bool operator==(const OwningAllocator<U> &other) const
+        {
+            return pool == other.pool;
+        }
+
+        std::shared_ptr<PayloadPool> pool;
+    };
+
+  public:
+    PayloadPool(quint32 deviceId, const PayloadPoolPolicy &policy)
+        : m_deviceId(deviceId), m_pool(std::pmr::pool_options{policy.maxBlocksPerChunk, policy.largestPooledBlock}, &m_upstream)
+    {
+    }
+
+    PayloadPool(const PayloadPool &) = delete;
+    PayloadPool &operator=(const PayloadPool &) = delete;
+
+    quint32 deviceId() const
+    {
+        return m_deviceId;
+    }
+
+    // A zeroed array of count samples; the pool must be owned by a shared_ptr.
+    template <typename T> std::shared_ptr<std::pmr::vector<T>> makeArray(size_t count)
+    {
+        return std::allocate_shared<std::pmr::vector<T>>(OwningAllocator<std::pmr::vector<T>>(shared_from_this()), count, this);
+    }
+
+    PayloadPoolStats stats() const
+    {
+        return {m_deviceId, m_allocations.load(std::memory_order_relaxed), m_bytesInUse.load(std::memory_order_relaxed),
+                m_highWaterBytes.load(std::memory_order_relaxed), m_upstream.bytes()};
+    }
+
+  private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        auto *memory = m_pool.allocate(bytes, alignment);
+
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        const auto inUse = m_bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto highWater = m_highWaterBytes.load(std::memory_order_relaxed);
+        while (inUse > highWater && !m_highWaterBytes.compare_exchange_weak(highWater, inUse, std::memory_order_relaxed))
+        {
+        }
+
+        return memory;
+    }
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override
+    {
+        m_pool.deallocate(memory, bytes, alignment);
+        m_bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    const quint32 m_deviceId;
+    UpstreamResource m_upstream;
+    std::pmr::synchronized_pool_resource m_pool;
+
+    std::atomic<quint64> m_allocations{};
+    std::atomic<quint64> m_bytesInUse{};
+    std::atomic<quint64> m_highWaterBytes{};
+};
+
+class PayloadPools final
+{
+  public:
+    static PayloadPools &instance()
+    {
+        static PayloadPools pools;
+        return pools;
+    }
+
+    // Applies to pools created afterwards.
+    void setPolicy(const PayloadPoolPolicy &policy)
+    {
+        std::lock_guard lock(m_mutex);
+        m_policy = policy;
+    }
+
+    // The live pool of deviceId, or a new one; nullptr if pooling is disabled.
+    std::shared_ptr<PayloadPool> attach(quint32 deviceId)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (auto pool = m_pools[deviceId].lock())
+            return pool;
+
+        if (!m_policy.enabled)
+            return nullptr;
+
+        auto pool = std::make_shared<PayloadPool>(deviceId, m_policy);
+        m_pools[deviceId] = pool;
+        return pool;
+    }
+
+    std::vector<PayloadPoolStats> snapshot()
+    {
+        std::lock_guard lock(m_mutex);
+
+        std::vector<PayloadPoolStats> result;
+        for (auto it = m_pools.begin(); it != m_pools.end();)
+        {
+            if (const auto pool = it->second.lock())
+            {
+                result.push_back(pool->stats());
+                ++it;
+            }
+            else
+            {
+                it = m_pools.erase(it);
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    std::mutex m_mutex;
+    PayloadPoolPolicy m_policy;
+    std::map<quint32, std::weak_ptr<PayloadPool>> m_pools;
+};
+
+} // namespace network
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QByteArrayView>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace network
+{
+
+/*
+ * Trailer signature search for packets without a length field
+ * (Detectron2dNetworkPacket).
+ *
+ * Candidate positions are firstPosition + i * stride for i < limit, and each
+ * candidate needs the signature plus the 16-bit checksum behind it. With a
+ * 16-byte stride every candidate lives in its own vector-sized block, so a
+ * lane-wise SIMD compare does not test more than one candidate per load.
+ * Instead each candidate is tested with a single word compare (the signature
+ * fits into 64 bits), four candidates per iteration, and the loop only
+ * branches once per group.
+ */
+
+struct SignatureScanResult
+{
+    enum class Status
+    {
+        Found,
+        NeedMoreData,
+        NotFound
+    };
+
+    Status status{Status::NotFound};
+    quint32 index{};
+};
+
+template <size_t N>
+    requires(N > 0 && N <= sizeof(quint64))
+class SignatureScanner final
+{
+  public:
+    explicit constexpr SignatureScanner(const std::array<char, N> &signature)
+    {
+        for (size_t i = 0; i < N; ++i)
+            m_pattern[i] = signature[i];
+    }
+
+    SignatureScanResult scan(QByteArrayView data, quint32 firstPosition, quint32 stride, quint32 limit, quint32 firstIndex = 0) const
+    {
+        const quint64 pattern = load(m_pattern);
+        const auto *bytes = data.constData();
+        const auto tailSize = static_cast<qsizetype>(N + sizeof(quint16));
+
+        quint32 available = 0;
+        if (data.size() >= static_cast<qsizetype>(firstPosition) + tailSize)
+            available = static_cast<quint32>((data.size() - firstPosition - tailSize) / stride + 1);
+
+        const quint32 end = std::min(available, limit);
+        quint32 i = firstIndex;
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const auto *base = bytes + firstPosition + static_cast<qsizetype>(i) * stride;
+            const unsigned hits = static_cast<unsigned>(load(base) == pattern) | static_cast<unsigned>(load(base + stride) == pattern) << 1 |
+                                  static_cast<unsigned>(load(base + 2 * stride) == pattern) << 2 |
+                                  static_cast<unsigned>(load(base + 3 * stride) == pattern) << 3;
+            if (hits != 0)
+                return {SignatureScanResult::Status::Found, i + static_cast<quint32>(std::countr_zero(hits))};
+        }
+
+        for (; i < end; ++i)
+        {
+            if (load(bytes + firstPosition + static_cast<qsizetype>(i) * stride) == pattern)
+                return {SignatureScanResult::Status::Found, i};
+        }
+
+        if (end < limit)
+            return {SignatureScanResult::Status::NeedMoreData, end};
+
+        return {SignatureScanResult::Status::NotFound, limit};
+    }
+
+  private:
+    static quint64 load(const char *data)
+    {
+        quint64 word = 0;
+        std::memcpy(&word, data, N);
+        return word;
+    }
+
+    char m_pattern[N]{};
+};
+
+} // namespace network
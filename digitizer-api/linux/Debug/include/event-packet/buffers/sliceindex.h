@@ -0,0 +1,353 @@
+#pragma once
+
+#include "packetsizeutils.h"
+#include "packets/eventpackettype.h"
+
+#include <QByteArrayView>
+#include <QPair>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+#include <expected>
+#include <utility>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Single-pass framing of a received chunk.
+ *
+ * SliceIndexer walks the chunk once, packet by packet, and records every
+ * complete packet in a compact table: type, offset, length, channel and
+ * rtc, read with little-endian loads straight from the header. Routing
+ * (rangesOf), info/waveform pairing (startsPair, pairSlices), filtering and
+ * statistics then run on the table without touching the packet bytes again.
+ *
+ * Sizes come from a per-type table built once from the packet structures,
+ * so the walk costs one indirect call per packet. The indexer carries the
+ * framing of an incomplete packet over to the next chunk; FramingStage
+ * drives it over a device's receive slabs.
+ */
+
+struct PacketSliceEntry
+{
+    quint64 rtc{};
+    int offset{};
+    int length{};
+    quint16 channelId{};
+    EventPacketType type{EventPacketType::InvalidEventInfo};
+};
+
+static_assert(sizeof(PacketSliceEntry) == 24);
+
+enum class SliceIndexStatus
+{
+    Complete,     // the chunk ends on a packet boundary
+    NeedMoreData, // the last packet is incomplete; it starts at consumedBytes
+    Broken        // the bytes at consumedBytes are not a valid header for this device
+};
+
+struct SliceIndex
+{
+    std::vector<PacketSliceEntry> slices;
+    int consumedBytes{};
+    SliceIndexStatus status{SliceIndexStatus::Complete};
+
+    void clear()
+    {
+        slices.clear();
+        consumedBytes = 0;
+        status = SliceIndexStatus::Complete;
+    }
+
+    // Slices of one type in the (offset, length) form taken by the parser workers.
+    QVector<QPair<int, int>> rangesOf(EventPacketType type) const
+    {
+        QVector<QPair<int, int>> ranges;
+        for (const auto &slice : slices)
+        {
+            if (slice.type == type)
+                ranges.push_back(qMakePair(slice.offset, slice.length));
+        }
+
+        return ranges;
+    }
+};
+
+/*
+ * Framing progress of the packet that did not fit into the previous chunk:
+ * its announced size once the header is complete, and for trailer-terminated
+ * packets the first signature candidate that has not been checked yet.
+ */
+struct PendingPacket
+{
+    int expectedSize{};
+    quint32 scanIndex{};
+};
+
+namespace slice_detail
+{
+
+constexpr int packetAlignment = 8;
+
+struct PacketFraming
+{
+    std::expected<int, EventError> (*frame)(QByteArrayView buffer, int offset, PendingPacket &pending) = nullptr;
+    quint32 rtcOffset{};
+    quint32 channelIdOffset{};
+    bool hasRtc{};
+};
+
+template <typename T> std::expected<int, EventError> frameAs(QByteArrayView buffer, int offset, PendingPacket &pending)
+{
+    if constexpr (UnknownSizeStructure<T>)
+    {
+        if (buffer.size() - offset < static_cast<int>(T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        static constexpr SignatureScanner scanner(T::signatureBytes);
+        const auto scan = scanner.scan(buffer.sliced(offset), T::fixedPartSize(), T::arrayPartSize(), T::arrayLimit(), pending.scanIndex);
+
+        if (scan.status == SignatureScanResult::Status::NeedMoreData)
+        {
+            pending.scanIndex = scan.index;
+            return std::unexpected(EventError::NotEnoughBytes);
+        }
+
+        if (scan.status == SignatureScanResult::Status::NotFound)
+            return std::unexpected(EventError::ParseError);
+
+        return static_cast<int>(T::fixedPartSize() + scan.index * T::arrayPartSize() + T::signatureBytes.size() + sizeof(quint16));
+    }
+    else
+    {
+        const auto packetSize = framedPacketSize<T>(buffer, offset);
+        if (!packetSize && packetSize.error() == EventError::NotEnoughBytes)
+        {
+            if constexpr (FixedSizeStructure<T>)
+                pending.expectedSize = static_cast<int>(T::size());
+            else if (buffer.size() - offset >= static_cast<int>(T::fixedPartSize()))
+                pending.expectedSize = static_cast<int>(announcedPacketSize<T>(buffer.constData() + offset));
+        }
+
+        // The device pads variable-size packets to 8 bytes; anything else is a corrupted length or padding field.
+        if constexpr (KnownSizeStructure<T>)
+        {
+            if (pending.expectedSize % packetAlignment != 0 || (packetSize && *packetSize % packetAlignment != 0))
+            {
+                pending = {};
+                return std::unexpected(EventError::ParseError);
+            }
+        }
+
+        return packetSize;
+    }
+}
+
+template <typename T> constexpr PacketFraming framingFor()
+{
+    PacketFraming framing;
+    framing.frame = &frameAs<T>;
+    framing.channelIdOffset = T::Layout::template offsetOf<&T::channelId>();
+
+    if constexpr (requires { &T::rtc; })
+    {
+        framing.rtcOffset = T::Layout::template offsetOf<&T::rtc>();
+        framing.hasRtc = true;
+    }
+    else if constexpr (requires { &T::rtcChopper; })
+    {
+        framing.rtcOffset = T::Layout::template offsetOf<&T::rtcChopper>();
+        framing.hasRtc = true;
+    }
+
+    return framing;
+}
+
+inline const std::array<PacketFraming, 256> &framingTable()
+{
+    static const std::array<PacketFraming, 256> table = [] {
+        std::array<PacketFraming, 256> result{};
+        for (size_t type = 0; type < result.size(); ++type)
+        {
+            const auto framing = visitPacketStructure(static_cast<EventPacketType>(type),
+                                                      [](auto structure) { return framingFor<typename decltype(structure)::type>(); });
+            if (framing)
+                result[type] = *framing;
+        }
+
+        return result;
+    }();
+
+    return table;
+}
+
+} // namespace slice_detail
+
+/*
+ * Incremental framing across partial reads.
+ *
+ * index() appends every complete packet of buffer, starting at from, and
+ * stops at the first incomplete packet (NeedMoreData) or at bytes that are
+ * not a header of this device (Broken), which includes headers announcing
+ * more than maxPacketSize() bytes; consumedBytes is the offset of that
+ * point. An incomplete packet is remembered: the next call, which must start
+ * at that packet again, returns at once while fewer than the announced bytes
+ * are buffered, and resumes a trailer scan at the first unchecked candidate.
+ * Each byte is thus examined once however the stream is fragmented. Call
+ * reset() after discarding or resyncing the buffer.
+ */
+class SliceIndexer final
+{
+  public:
+    explicit SliceIndexer(quint32 deviceId) : m_deviceId(deviceId)
+    {
+    }
+
+    const PendingPacket &pending() const
+    {
+        return m_pending;
+    }
+
+    // Bytes still missing from the pending packet at from, or 0 if its size is not known yet.
+    int missingBytes(QByteArrayView buffer, int from = 0) const
+    {
+        return std::max(m_pending.expectedSize - static_cast<int>(buffer.size() - from), 0);
+    }
+
+    void reset()
+    {
+        m_pending = {};
+    }
+
+    int maxPacketSize() const
+    {
+        return m_maxPacketSize;
+    }
+
+    // A corrupted length field otherwise holds up the stream until that many bytes arrived.
+    void setMaxPacketSize(int size)
+    {
+        m_maxPacketSize = size;
+    }
+
+    void index(QByteArrayView buffer, SliceIndex &index, int from = 0)
+    {
+        constexpr int headerSize = sizeof(quint32) + sizeof(EventPacketType);
+
+        const auto &framingTable = slice_detail::framingTable();
+        const auto *data = buffer.constData();
+        const int size = static_cast<int>(buffer.size());
+
+        int offset = from;
+        index.status = SliceIndexStatus::Complete;
+
+        while (offset < size)
+        {
+            if (size - offset < std::max(headerSize, m_pending.expectedSize))
+            {
+                index.status = SliceIndexStatus::NeedMoreData;
+                break;
+            }
+
+            const auto type = static_cast<EventPacketType>(data[offset + sizeof(quint32)]);
+            const auto &framing = framingTable[static_cast<quint8>(type)];
+
+            if (qFromLittleEndian<quint32>(data + offset) != m_deviceId || !framing.frame)
+            {
+                reset();
+                index.status = SliceIndexStatus::Broken;
+                break;
+            }
+
+            std::expected<int, EventError> length = m_pending.expectedSize;
+            if (m_pending.expectedSize == 0)
+                length = framing.frame(buffer, offset, m_pending);
+
+            if (m_pending.expectedSize > m_maxPacketSize || (length && *length > m_maxPacketSize))
+            {
+                reset();
+                index.status = SliceIndexStatus::Broken;
+                break;
+            }
+
+            if (!length)
+            {
+                if (length.error() == EventError::NotEnoughBytes)
+                {
+                    index.status = SliceIndexStatus::NeedMoreData;
+                }
+                else
+                {
+                    reset();
+                    index.status = SliceIndexStatus::Broken;
+                }
+                break;
+            }
+
+            PacketSliceEntry entry;
+            entry.rtc = framing.hasRtc ? qFromLittleEndian<quint64>(data + offset + framing.rtcOffset) : 0;
+            entry.offset = offset;
+            entry.length = *length;
+            entry.channelId = qFromLittleEndian<quint16>(data + offset + framing.channelIdOffset);
+            entry.type = type;
+            index.slices.push_back(entry);
+
+            offset += *length;
+            reset();
+        }
+
+        index.consumedBytes = offset;
+    }
+
+  private:
+    quint32 m_deviceId{};
+    int m_maxPacketSize{4 * 1024 * 1024};
+    PendingPacket m_pending;
+};
+
+// Whether slices[i] is an infoType slice whose waveType partner directly follows it with the same rtc.
+inline bool startsPair(const std::vector<PacketSliceEntry> &slices, qsizetype i, EventPacketType infoType, EventPacketType waveType)
+{
+    const auto next = i + 1;
+    return slices[i].type == infoType && next < static_cast<qsizetype>(slices.size()) && slices[next].type == waveType && slices[next].rtc == slices[i].rtc;
+}
+
+/*
+ * Pairs each infoType slice with the waveType slice that directly follows it
+ * and carries the same rtc. Returns indices into index.slices; a slice
+ * without a partner is paired with -1.
+ */
+inline std::vector<std::pair<qsizetype, qsizetype>> pairSlices(const SliceIndex &index, EventPacketType infoType, EventPacketType waveType)
+{
+    std::vector<std::pair<qsizetype, qsizetype>> pairs;
+    const auto &slices = index.slices;
+
+    for (qsizetype i = 0; i < static_cast<qsizetype>(slices.size()); ++i)
+    {
+        const auto &slice = slices[i];
+        if (slice.type == infoType)
+        {
+            if (startsPair(slices, i, infoType, waveType))
+            {
+                pairs.emplace_back(i, i + 1);
+                ++i;
+            }
+            else
+            {
+                pairs.emplace_back(i, -1);
+            }
+        }
+        else if (slice.type == waveType)
+        {
+            pairs.emplace_back(-1, i);
+        }
+    }
+
+    return pairs;
+}
+
+} // namespace network
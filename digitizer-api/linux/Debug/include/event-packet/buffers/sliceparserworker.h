@@ -0,0 +1,90 @@
+#pragma once
+
+#include "packetparser.h"
+#include "sliceworker.h"
+
+#include <QPair>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <memory>
+
+namespace network
+{
+
+/*
+ * Executor-driven counterpart of PacketParserWorker: jobs are queued on a
+ * SliceWorker ring and parsed by the shared ParserExecutor instead of a
+ * dedicated QThread, and packets are decoded straight from the slice into a
+ * NetworkPacket. PacketBuffer keeps using PacketParserWorker; this type is
+ * only created by code that opts in to the slice pipeline.
+ */
+template <NetworkPacketAlternative T> class SliceParserWorker final : public SliceWorker
+{
+  public:
+    explicit SliceParserWorker(std::unique_ptr<PacketParser<T>> parser) : m_parser(std::move(parser))
+    {
+    }
+
+    ~SliceParserWorker() override
+    {
+        shutdown();
+    }
+
+    EventPacketType packetType() const
+    {
+        return m_parser->packetType();
+    }
+
+    void parseBytes(const QByteArray &bytes)
+    {
+        auto shared = QSharedPointer<QByteArray>::create(bytes);
+        const auto length = static_cast<int>(shared->size());
+        enqueueSlice(std::move(shared), 0, length);
+    }
+
+    void enqueueSlices(const QSharedPointer<QByteArray> &buffer, const QVector<QPair<int, int>> &slices)
+    {
+        if (!buffer)
+        {
+            reject(EventError::ParseError, m_parser->packetType());
+            return;
+        }
+
+        for (const auto &[offset, length] : slices)
+            enqueueSlice(buffer, offset, length);
+    }
+
+    Intake enqueueSlice(QSharedPointer<QByteArray> buffer, int offset, int length)
+    {
+        if (!isValidSlice(buffer, offset, length))
+        {
+            reject(EventError::ParseError, m_parser->packetType());
+            return Intake::Dropped;
+        }
+
+        return submit(SliceJob{std::move(buffer), offset, length});
+    }
+
+  protected:
+    void processJob(const SliceJob &job, ParsedSlice &slice) override
+    {
+        const QByteArrayView view(job.buffer->constData() + job.offset, job.length);
+        auto result = m_parser->decodePacket(view);
+        if (!result.has_value())
+            slice.failed(result.error(), m_parser->packetType());
+        else
+            slice.parsed(NetworkPacket(std::in_place_type<T>, std::move(*result)), m_parser->packetType());
+    }
+
+    bool isWaveformJob(const SliceJob &job) const override
+    {
+        Q_UNUSED(job)
+        return std::is_same_v<T, WaveformNetworkPacket>;
+    }
+
+  private:
+    std::unique_ptr<PacketParser<T>> m_parser;
+};
+
+} // namespace network
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
+#include <array>
+
 namespace network
 {
 
@@ -37,23 +40,27 @@ struct event_info_detectron_xy_t
 
     friend QDataStream &operator>>(QDataStream &in, event_info_detectron_xy_t &xy)
     {
-        in >> xy.channelNum >> xy.amp1 >> xy.amp2 >> xy.rtc;
-        return in;
+        return Layout::read(in, xy);
     }
+
+    using Layout = WireLayout<WireField<"channelNum", &event_info_detectron_xy_t::channelNum, 0>,
+                              WireField<"amp1", &event_info_detectron_xy_t::amp1, 4>,
+                              WireField<"amp2", &event_info_detectron_xy_t::amp2, 6>,
+                              WireField<"rtc", &event_info_detectron_xy_t::rtc, 8>>;
 };
 
+static_assert(event_info_detectron_xy_t::Layout::size() == 16);
+static_assert(event_info_detectron_xy_t::Layout::isContiguous());
+
 struct Detectron2dNetworkPacket
 {
-    QDataStream &deserialize(QDataStream &in, size_t count)
+    template <typename Stream> Stream &deserialize(Stream &in, size_t count)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtcChopper;
+        Layout::read(in, *this);
 
-        for (auto i = 0; i < count; ++i)
-        {
-            event_info_detectron_xy_t xy;
-            in >> xy;
-            data.push_back(xy);
-        }
+        data.resize(count);
+        for (auto &xy : data)
+            event_info_detectron_xy_t::Layout::read(in, xy);
 
         in >> receivedSignature[0] >> receivedSignature[1] >> receivedSignature[2];
         in >> checksum;
@@ -63,12 +70,12 @@ struct Detectron2dNetworkPacket
 
     static quint32 fixedPartSize()
     {
-        return 16;
+        return Layout::size();
     }
 
     static quint32 arrayPartSize()
     {
-        return 16;
+        return event_info_detectron_xy_t::Layout::size();
     }
 
     static quint32 arrayLimit()
@@ -76,9 +83,11 @@ struct Detectron2dNetworkPacket
         return 64;
     }
 
+    static constexpr std::array<char, 6> signatureBytes{'\x11', '\xD0', '\xE1', '\xFE', '\xAD', '\xDE'};
+
     static QByteArray signature()
     {
-        return QByteArray::fromHex(QString("11D0E1FEADDE").toUtf8());
+        return QByteArray::fromRawData(signatureBytes.data(), signatureBytes.size());
     }
 
     //[HEADER]
@@ -94,6 +103,16 @@ struct Detectron2dNetworkPacket
     //[END]
     quint16 receivedSignature[3];
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &Detectron2dNetworkPacket::deviceId, 0>,
+                              WireField<"packetType", &Detectron2dNetworkPacket::packetType, 4>,
+                              WireField<"flags", &Detectron2dNetworkPacket::flags, 5>,
+                              WireField<"channelId", &Detectron2dNetworkPacket::channelId, 6>,
+                              WireField<"rtcChopper", &Detectron2dNetworkPacket::rtcChopper, 8>>;
 };
 
+static_assert(Detectron2dNetworkPacket::Layout::size() == 16);
+static_assert(Detectron2dNetworkPacket::Layout::isContiguous());
+
 } // namespace network
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -36,15 +37,12 @@ struct PsdNetworkPacketV2
 {
     static size_t size()
     {
-        return 48;
+        return Layout::size();
     }
 
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc >> qShort >> qLong >> cfdY1 >> cfdY2 >> baseline >> height >> eventCounter >>
-            eventCounterPsd >> channelIdDouble >> spectrumBin >> psdValue >> checksum;
-
-        return in;
+        return Layout::read(in, *this);
     }
 
     //[HEADER]
@@ -66,6 +64,28 @@ struct PsdNetworkPacketV2
     quint16 spectrumBin{};
     qint16 psdValue{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &PsdNetworkPacketV2::deviceId, 0>,
+                              WireField<"packetType", &PsdNetworkPacketV2::packetType, 4>,
+                              WireField<"flags", &PsdNetworkPacketV2::flags, 5>,
+                              WireField<"channelId", &PsdNetworkPacketV2::channelId, 6>,
+                              WireField<"rtc", &PsdNetworkPacketV2::rtc, 8>,
+                              WireField<"qShort", &PsdNetworkPacketV2::qShort, 16>,
+                              WireField<"qLong", &PsdNetworkPacketV2::qLong, 20>,
+                              WireField<"cfdY1", &PsdNetworkPacketV2::cfdY1, 24>,
+                              WireField<"cfdY2", &PsdNetworkPacketV2::cfdY2, 26>,
+                              WireField<"baseline", &PsdNetworkPacketV2::baseline, 28>,
+                              WireField<"height", &PsdNetworkPacketV2::height, 30>,
+                              WireField<"eventCounter", &PsdNetworkPacketV2::eventCounter, 32>,
+                              WireField<"eventCounterPsd", &PsdNetworkPacketV2::eventCounterPsd, 36>,
+                              WireField<"channelIdDouble", &PsdNetworkPacketV2::channelIdDouble, 40>,
+                              WireField<"spectrumBin", &PsdNetworkPacketV2::spectrumBin, 42>,
+                              WireField<"psdValue", &PsdNetworkPacketV2::psdValue, 44>,
+                              WireField<"checksum", &PsdNetworkPacketV2::checksum, 46>>;
 };
 
+static_assert(PsdNetworkPacketV2::Layout::size() == 48);
+static_assert(PsdNetworkPacketV2::Layout::isContiguous());
+
 } // namespace network
@@ -173,6 +173,15 @@ class WaveformEventPacket : public EventPacket
         m_waveform = packet.array;
     }
 
+    // Takes over the samples of a packet that is not used afterwards instead of copying them.
+    WaveformEventPacket(WaveformNetworkPacket &&packet)
+    {
+        m_header = {.deviceId = packet.deviceId, .packetType = packet.packetType, .flags = packet.flags, .channelId = packet.channelId, .rtc = packet.rtc};
+        m_decimationFactor = packet.decimationFactor;
+        m_paddingLength = packet.paddingLength;
+        m_waveform = std::move(packet.array);
+    }
+
     void serialize(QDataStream &out) const override;
     void serializePadding(QDataStream &out) const override;
     void deserialize(QDataStream &in) override;
@@ -211,6 +220,14 @@ class SpectrumEventPacket : public EventPacket
         m_spectrum = packet.array;
     }
 
+    SpectrumEventPacket(DeviceSpectrum32 &&packet)
+    {
+        m_header = {.deviceId = packet.deviceId, .packetType = packet.packetType, .flags = packet.flags, .channelId = packet.channelId, .rtc = packet.rtc};
+        m_spectrumType = static_cast<SpectrumType>(packet.spectrumType);
+        m_paddingLength = packet.paddingLength;
+        m_spectrum = std::move(packet.array);
+    }
+
     void serialize(QDataStream &out) const override;
     void serializePadding(QDataStream &out) const override;
     void deserialize(QDataStream &in) override;
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "slabpool.h"
+#include "sliceindex.h"
+#include "streamresync.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <atomic>
+
+namespace network
+{
+
+/*
+ * Framing of a device's receive stream into packet slices.
+ *
+ * Chunks arrive in stream order as slices of receive slabs. push() frames
+ * each one with the SliceIndexer and hands the resulting SliceIndex, whose
+ * offsets are relative to the backing buffer, to the dispatch callback
+ * together with that buffer. Chunks that continue the previous one in the
+ * same slab only extend the unframed range, so the slices handed on point
+ * straight into the slab.
+ *
+ * When the stream moves to a new slab while a packet is still incomplete,
+ * only that packet is stitched into a carry buffer: its tail and, once the
+ * indexer knows its size, the bytes still missing from the new chunk.
+ * Framing then continues in the new slab. While the size is not known yet
+ * the whole chunk is carried. A carry buffer is extended in place only as
+ * long as no slice of it was handed out; once workers may be reading it,
+ * the next stitch starts a new one.
+ *
+ * At a broken header (SliceIndexStatus::Broken) framing does not flush the
+ * buffered bytes: StreamResync looks for the next complete, checksummed
+ * packet behind it and framing resumes there, so good packets after the
+ * corruption are kept. The bytes skipped on the way are counted as
+ * discarded; while no valid packet is in sight yet, the bytes from the
+ * first plausible candidate on are kept until more data arrives.
+ *
+ * Used by one thread, the pipeline's framing thread.
+ */
+
+struct FramingStats
+{
+    quint64 chunks{};
+    quint64 bytes{};
+    quint64 slices{};
+    quint64 carriedBytes{};   // bytes copied into carry buffers
+    quint64 discardedBytes{}; // bytes skipped while resynchronizing or left over at the end
+    quint64 resyncs{};        // broken headers the stream was resynchronized after
+};
+
+class FramingStage final
+{
+  public:
+    explicit FramingStage(quint32 deviceId) : m_indexer(deviceId), m_resync(deviceId)
+    {
+    }
+
+    FramingStage(const FramingStage &) = delete;
+    FramingStage &operator=(const FramingStage &) = delete;
+
+    // Adds chunk to the unframed range and calls dispatch(buffer, index) with the slices it completes.
+    template <typename Dispatch> SliceIndexStatus push(const SlabPool::Chunk &chunk, Dispatch &&dispatch)
+    {
+        if (!chunk.slab || chunk.length <= 0)
+            return SliceIndexStatus::Complete;
+
+        m_chunks.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(static_cast<quint64>(chunk.length), std::memory_order_relaxed);
+
+        if (m_buffer == chunk.slab && chunk.offset == m_end)
+        {
+            m_end += chunk.length;
+            return frame(dispatch);
+        }
+
+        if (m_begin == m_end)
+        {
+            adopt(chunk.slab, chunk.offset, chunk.length);
+            return frame(dispatch);
+        }
+
+        const int missing = m_indexer.missingBytes(QByteArrayView(m_buffer->constData(), m_end), m_begin);
+        const int carried = missing > 0 ? std::min(missing, chunk.length) : chunk.length;
+        stitch(chunk.bytes().first(carried));
+
+        const auto status = frame(dispatch);
+        if (carried == chunk.length)
+            return status;
+
+        // The carry held just the pending packet, so the rest of the chunk is framed in place.
+        if (m_begin != m_end)
+            stitch(chunk.bytes().sliced(carried));
+        else
+            adopt(chunk.slab, chunk.offset + carried, chunk.length - carried);
+
+        return frame(dispatch);
+    }
+
+    // Drops the next `bytes` unframed bytes.
+    void discard(int bytes)
+    {
+        bytes = std::clamp(bytes, 0, m_end - m_begin);
+        m_begin += bytes;
+        m_discardedBytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+        m_indexer.reset();
+
+        if (m_begin == m_end)
+            release();
+    }
+
+    // Packets announcing more are treated as corruption; see StreamResync::setMaxPacketSize().
+    void setMaxPacketSize(int size)
+    {
+        m_indexer.setMaxPacketSize(size);
+        m_resync.setMaxPacketSize(size);
+    }
+
+    // Bytes received but not framed yet.
+    int pendingBytes() const
+    {
+        return m_end - m_begin;
+    }
+
+    FramingStats stats() const
+    {
+        return {m_chunks.load(std::memory_order_relaxed), m_bytes.load(std::memory_order_relaxed), m_slices.load(std::memory_order_relaxed),
+                m_carriedBytes.load(std::memory_order_relaxed), m_discardedBytes.load(std::memory_order_relaxed), m_resyncs.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    template <typename Dispatch> SliceIndexStatus frame(Dispatch &&dispatch)
+    {
+        while (m_begin != m_end)
+        {
+            if (m_resyncing && !resync())
+                return SliceIndexStatus::Broken;
+
+            m_index.clear();
+            m_indexer.index(QByteArrayView(m_buffer->constData(), m_end), m_index, m_begin);
+
+            if (!m_index.slices.empty())
+            {
+                m_slices.fetch_add(m_index.slices.size(), std::memory_order_relaxed);
+                m_shared = true;
+                dispatch(m_buffer, std::as_const(m_index));
+            }
+
+            m_begin = m_index.consumedBytes;
+            if (m_index.status != SliceIndexStatus::Broken)
+            {
+                if (m_begin == m_end)
+                    release();
+
+                return m_index.status;
+            }
+
+            // The header at m_begin is bad; look for the next packet behind it.
+            m_resyncs.fetch_add(1, std::memory_order_relaxed);
+            m_resyncing = true;
+            discard(1);
+        }
+
+        return m_resyncing ? SliceIndexStatus::Broken : SliceIndexStatus::Complete;
+    }
+
+    // Skips to the next plausible packet; false while none is complete in the bytes received so far.
+    bool resync()
+    {
+        const auto result = m_resync.resync(QByteArrayView(m_buffer->constData(), m_end), m_begin);
+        discard(result.offset - m_begin);
+
+        m_resyncing = result.status != ResyncResult::Status::Found;
+        return !m_resyncing;
+    }
+
+    void adopt(const QSharedPointer<QByteArray> &slab, int offset, int length)
+    {
+        m_buffer = slab;
+        m_begin = offset;
+        m_end = offset + length;
+        m_ownsBuffer = false;
+        m_shared = false;
+    }
+
+    void stitch(QByteArrayView bytes)
+    {
+        if (m_ownsBuffer && !m_shared)
+        {
+            // Nobody reads this carry buffer yet, so it may grow in place.
+            m_buffer->append(bytes.constData(), bytes.size());
+        }
+        else
+        {
+            auto carry = QSharedPointer<QByteArray>::create();
+            carry->reserve(m_end - m_begin + bytes.size());
+            carry->append(m_buffer->constData() + m_begin, m_end - m_begin);
+            carry->append(bytes.constData(), bytes.size());
+
+            m_carriedBytes.fetch_add(static_cast<quint64>(m_end - m_begin), std::memory_order_relaxed);
+            m_buffer = std::move(carry);
+            m_begin = 0;
+            m_ownsBuffer = true;
+            m_shared = false;
+        }
+
+        m_end = static_cast<int>(m_buffer->size());
+        m_carriedBytes.fetch_add(static_cast<quint64>(bytes.size()), std::memory_order_relaxed);
+    }
+
+    // Lets go of the backing buffer once everything in it is framed, so its slab can be recycled.
+    void release()
+    {
+        m_buffer.reset();
+        m_begin = 0;
+        m_end = 0;
+        m_ownsBuffer = false;
+        m_shared = false;
+    }
+
+    SliceIndexer m_indexer;
+    SliceIndex m_index;
+    StreamResync m_resync;
+    bool m_resyncing{false}; // looking for the next valid packet after a broken header
+
+    QSharedPointer<QByteArray> m_buffer;
+    int m_begin{};
+    int m_end{};
+    bool m_ownsBuffer{false}; // m_buffer is a carry buffer of ours, not a slab
+    bool m_shared{false};     // slices of m_buffer were handed out
+
+    std::atomic<quint64> m_chunks{};
+    std::atomic<quint64> m_bytes{};
+    std::atomic<quint64> m_slices{};
+    std::atomic<quint64> m_carriedBytes{};
+    std::atomic<quint64> m_discardedBytes{};
+    std::atomic<quint64> m_resyncs{};
+};
+
+} // namespace network
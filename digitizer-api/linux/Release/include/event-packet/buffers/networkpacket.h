@@ -0,0 +1,128 @@
+#pragma once
+
+#include "packetsizeutils.h"
+#include "packets/detectron2dnetworkpacket.h"
+#include "packets/detectronstatisticnetworkpacket.h"
+#include "packets/devicespectrum16.h"
+#include "packets/devicespectrum32.h"
+#include "packets/eventpackettype.h"
+#include "packets/phanetworkpacket.h"
+#include "packets/psdnetworkpacket.h"
+#include "packets/psdnetworkpacketv2.h"
+#include "packets/waveformnetworkpacket.h"
+
+#include <QMetaType>
+
+#include <any>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Closed set of decoded packet structures.
+ *
+ * A NetworkPacket holds any packet the parsers produce by value, so passing
+ * it through queues and queued signals needs neither a heap allocation per
+ * packet (as std::any does for every structure larger than its small buffer)
+ * nor an any_cast type check on the receiving side; consumers dispatch with
+ * std::visit. The alternatives are exactly the structures that
+ * visitPacketStructure() maps EventPacketType values to, which is checked at
+ * compile time below.
+ */
+
+using NetworkPacket = std::variant<PsdNetworkPacket, PsdNetworkPacketV2, PhaNetworkPacket, WaveformNetworkPacket, Detectron2dNetworkPacket,
+                                   DetectronStatisticNetworkPacket, DeviceSpectrum16, DeviceSpectrum32>;
+
+using NetworkPacketBatch = std::vector<NetworkPacket>;
+
+template <typename T, typename Variant> struct is_variant_alternative;
+
+template <typename T, typename... Alternatives>
+struct is_variant_alternative<T, std::variant<Alternatives...>> : std::bool_constant<(std::is_same_v<T, Alternatives> || ...)>
+{
+};
+
+template <typename T>
+concept NetworkPacketAlternative = is_variant_alternative<T, NetworkPacket>::value;
+
+static_assert(
+    [] {
+        for (int type = 0; type <= 0xFF; ++type)
+        {
+            const auto mapped = visitPacketStructure(static_cast<EventPacketType>(type),
+                                                     [](auto structure) { return NetworkPacketAlternative<typename decltype(structure)::type>; });
+            if (mapped.has_value() && !*mapped)
+                return false;
+        }
+
+        return true;
+    }(),
+    "Every packet structure known to visitPacketStructure() must be a NetworkPacket alternative");
+
+// Overload set for std::visit: std::visit(PacketVisitor{[](const PsdNetworkPacket &) {}, [](const auto &) {}}, packet).
+template <typename... Handlers> struct PacketVisitor : Handlers...
+{
+    using Handlers::operator()...;
+};
+
+inline EventPacketType packetTypeOf(const NetworkPacket &packet)
+{
+    return std::visit([](const auto &alternative) { return alternative.packetType; }, packet);
+}
+
+// Memory held by packet, for the stage budgets: the value itself plus its sample or hit array.
+inline qint64 packetBytes(const NetworkPacket &packet)
+{
+    return std::visit(
+        [](const auto &alternative) {
+            auto bytes = static_cast<qint64>(sizeof(NetworkPacket));
+            if constexpr (requires { alternative.array.size(); })
+                bytes += static_cast<qint64>(alternative.array.size() * sizeof(typename decltype(alternative.array)::value_type));
+            if constexpr (requires { alternative.data.size(); })
+                bytes += static_cast<qint64>(alternative.data.size() * sizeof(typename decltype(alternative.data)::value_type));
+            return bytes;
+        },
+        packet);
+}
+
+/*
+ * Bridge from the std::any based signals (PacketBuffer::packetParsed,
+ * PacketParserWorkerBase::parsed): moves the boxed structure into a
+ * NetworkPacket, or returns std::nullopt if it is not a packet structure.
+ */
+inline std::optional<NetworkPacket> toNetworkPacket(std::any &&packet)
+{
+    return [&]<typename... Alternatives>(std::type_identity<std::variant<Alternatives...>>) -> std::optional<NetworkPacket> {
+        std::optional<NetworkPacket> result;
+        (
+            [&] {
+                if (auto *alternative = std::any_cast<Alternatives>(&packet); alternative && !result)
+                    result.emplace(std::in_place_type<Alternatives>, std::move(*alternative));
+            }(),
+            ...);
+
+        return result;
+    }(std::type_identity<NetworkPacket>{});
+}
+
+inline NetworkPacketBatch toNetworkPacketBatch(std::vector<std::any> &&packets)
+{
+    NetworkPacketBatch batch;
+    batch.reserve(packets.size());
+
+    for (auto &packet : packets)
+    {
+        if (auto converted = toNetworkPacket(std::move(packet)))
+            batch.push_back(std::move(*converted));
+    }
+
+    return batch;
+}
+
+} // namespace network
+
+Q_DECLARE_METATYPE(network::NetworkPacket)
+Q_DECLARE_METATYPE(network::NetworkPacketBatch)
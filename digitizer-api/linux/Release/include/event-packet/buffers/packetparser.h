@@ -1,38 +1,26 @@
 #pragma once
 
+#include "eventerror.h"
+#include "packetchecksum.h"
+#include "packetview.h"
+#include "parsediagnostics.h"
+#include "signaturescanner.h"
 #include "packets/eventpackettype.h"
+#include "packets/littleendianreader.h"
 
+#include <QByteArrayView>
 #include <QDataStream>
 #include <QDebug>
+#include <QSharedPointer>
+#include <QtEndian>
 
 #include <expected>
+#include <optional>
+#include <utility>
 
 namespace network
 {
 
-inline quint16 calculateChecksum(const QByteArray &data)
-{
-    quint16 checksum = 0, wordsCnt = static_cast<quint16>(data.size()) / 2;
-    const auto *buff = reinterpret_cast<const quint16 *>(data.data());
-
-    for (auto it = buff; it < buff + wordsCnt; it++)
-        checksum += *it;
-
-    checksum = ~checksum;
-
-    return checksum;
-}
-
-enum class EventError
-{
-    NotEnoughBytes,
-    InvalidDeviceId,
-    UnsupportedPacketType,
-    ChecksumMismatch,
-    ParseError,
-    RtcMismatch
-};
-
 template <typename T, auto fieldPtr, typename U>
 concept has_field = requires(T t) {
     { t.*fieldPtr } -> std::convertible_to<U>;
@@ -58,6 +46,7 @@ concept FixedSizeStructure = requires(T t) {
     requires has_no_signature_field<T>;
 
     { T::size() } -> std::same_as<size_t>;
+    { T::Layout::size() } -> std::same_as<quint32>;
     { t.deserialize(std::declval<QDataStream &>()) } -> std::same_as<QDataStream &>;
 };
 
@@ -76,6 +65,7 @@ concept KnownSizeStructure = requires(T t) {
     { t.paddingLengthOffset() } -> std::same_as<quint32>;
     { t.fixedPartSize() } -> std::same_as<quint32>;
     { t.arrayItemSize() } -> std::same_as<quint32>;
+    { T::Layout::size() } -> std::same_as<quint32>;
 };
 
 template <typename T>
@@ -93,6 +83,7 @@ concept UnknownSizeStructure = requires(T t) {
     { t.arrayPartSize() } -> std::same_as<quint32>;
     { t.arrayLimit() } -> std::same_as<quint32>;
     { t.signature() } -> std::same_as<QByteArray>;
+    { SignatureScanner(T::signatureBytes) };
 };
 
 template <typename T> class PacketParser final
@@ -142,28 +133,40 @@ template <typename T> class PacketParser final
         T packet{};
         packet.deserialize(stream);
 
-        if (packet.deviceId != m_deviceId)
-        {
-            qWarning() << "Invalid device ID in packet. Expected:" << m_deviceId << "Received:" << packet.deviceId;
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::InvalidDeviceId);
-        }
+        if (const auto error = validate(packet, checksum))
+            return reject(*error, copy);
 
-        if (packet.packetType != m_packetType)
-        {
-            qWarning() << "Unsupported packet type. Expected:" << static_cast<int>(m_packetType) << "Received:" << static_cast<int>(packet.packetType);
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::UnsupportedPacketType);
-        }
+        return std::make_pair(packet, copy);
+    }
 
-        if (packet.checksum != checksum)
-        {
-            qWarning() << "Checksum mismatch in packet. Expected:" << checksum << "Received:" << packet.checksum;
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::ChecksumMismatch);
-        }
+    /*
+     * Validates a fixed-size packet like decodeFixedSizePacket(), then decodes
+     * its fields straight from packetArray into the columns of batch (see
+     * eventcolumns.h) instead of into a T. The caller keeps batch to the
+     * parser's device and packet type.
+     */
+    template <typename Columns>
+        requires FixedSizeStructure<T>
+    std::expected<void, EventError> parseInto(QByteArrayView packetArray, Columns &batch)
+    {
+        if (packetArray.size() < static_cast<int>(T::size()))
+            return std::unexpected(EventError::NotEnoughBytes);
 
-        return std::make_pair(packet, copy);
+        const auto packetView = packetArray.first(static_cast<qsizetype>(T::size()));
+        const auto checksum = calculateChecksum(packetView.chopped(sizeof(quint16)));
+        const auto *data = reinterpret_cast<const uchar *>(packetView.constData());
+
+        if (T::Layout::template load<&T::deviceId>(data) != m_deviceId)
+            return reject(EventError::InvalidDeviceId, packetView);
+
+        if (T::Layout::template load<&T::packetType>(data) != m_packetType)
+            return reject(EventError::UnsupportedPacketType, packetView);
+
+        if (T::Layout::template load<&T::checksum>(data) != checksum)
+            return reject(EventError::ChecksumMismatch, packetView);
+
+        batch.template append<T>(data);
+        return {};
     }
 
     std::expected<std::pair<T, QByteArray>, EventError> parseKnownSizePacket(QByteArrayView packetArray)
@@ -187,80 +190,147 @@ template <typename T> class PacketParser final
         T packet{};
         packet.deserialize(stream);
 
-        if (packet.deviceId != m_deviceId)
-        {
-            qWarning() << "Invalid device ID in packet. Expected:" << m_deviceId << "Received:" << packet.deviceId;
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::InvalidDeviceId);
-        }
+        if (const auto error = validate(packet, checksum))
+            return reject(*error, copy);
 
-        if (packet.packetType != m_packetType)
-        {
-            qWarning() << "Unsupported packet type. Expected:" << static_cast<int>(m_packetType) << "Received:" << static_cast<int>(packet.packetType);
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::UnsupportedPacketType);
-        }
+        return std::make_pair(packet, copy);
+    }
 
-        if (packet.checksum != checksum)
-        {
-            qWarning() << "Checksum mismatch in packet. Expected:" << checksum << "Received:" << packet.checksum;
-            qWarning() << "Packet array:" << copy.toHex();
-            return std::unexpected(EventError::ChecksumMismatch);
-        }
+    std::expected<PacketView<T>, EventError> parsePacketView(const QSharedPointer<QByteArray> &buffer, int offset, int length) const
+        requires KnownSizeStructure<T>
+    {
+        // offset is checked first so that size() - offset cannot wrap; offset + length could overflow int.
+        if (!buffer || offset < 0 || length < 0 || offset > buffer->size() || length > buffer->size() - offset)
+            return std::unexpected(EventError::ParseError);
 
-        return std::make_pair(packet, copy);
+        const QByteArrayView packetArray(buffer->constData() + offset, length);
+        if (packetArray.size() < static_cast<int>(T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        const auto arrayLength = qFromLittleEndian<quint32>(packetArray.constData() + T::arrayLengthOffset());
+        const auto paddingLength = qFromLittleEndian<quint16>(packetArray.constData() + T::paddingLengthOffset());
+        const quint64 checksumOffset64 = static_cast<quint64>(T::fixedPartSize()) + static_cast<quint64>(arrayLength) * static_cast<quint64>(T::arrayItemSize());
+        const quint64 totalSize64 = checksumOffset64 + static_cast<quint64>(sizeof(quint16)) + static_cast<quint64>(paddingLength) * sizeof(qint16);
+
+        if (std::cmp_less(packetArray.size(), totalSize64))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        const auto checksumOffset = static_cast<qsizetype>(checksumOffset64);
+        const auto totalSize = static_cast<int>(totalSize64);
+
+        quint32 deviceId{};
+        EventPacketType packetType{};
+        LittleEndianReader reader(packetArray);
+        reader >> deviceId >> packetType;
+
+        if (deviceId != m_deviceId)
+            return reject(EventError::InvalidDeviceId, packetArray);
+
+        if (packetType != m_packetType)
+            return reject(EventError::UnsupportedPacketType, packetArray);
+
+        const auto checksum = calculateChecksum(packetArray.first(checksumOffset));
+        const auto receivedChecksum = qFromLittleEndian<quint16>(packetArray.constData() + checksumOffset);
+        if (receivedChecksum != checksum)
+            return reject(EventError::ChecksumMismatch, packetArray);
+
+        return PacketView<T>(buffer, offset, totalSize);
     }
 
     std::expected<std::pair<T, QByteArray>, EventError> parseUnknownSizePacket(QByteArrayView packetArray)
     {
-        if (packetArray.size() < static_cast<int>(T::fixedPartSize()))
+        const auto located = locateUnknownSizePacket(packetArray);
+        if (!located)
+            return std::unexpected(located.error());
+
+        auto packet = decodeLocated(located->view, located->arrayCount);
+        if (!packet)
+            return std::unexpected(packet.error());
+
+        return std::make_pair(std::move(*packet), located->view.toByteArray());
+    }
+
+    /*
+     * Copy-free counterparts of the parse*() functions above. decodePacket()
+     * validates the packet at the start of packetArray and decodes it
+     * straight from the view: no QByteArray copy, no QDataStream. Both
+     * families count rejections in ParseDiagnostics. Sizes taken from the wire are computed in 64 bits
+     * and checked against the view before anything is sliced.
+     */
+    std::expected<T, EventError> decodePacket(QByteArrayView packetArray) const
+    {
+        if constexpr (FixedSizeStructure<T>)
+            return decodeFixedSizePacket(packetArray);
+        else if constexpr (KnownSizeStructure<T>)
+            return decodeKnownSizePacket(packetArray);
+        else if constexpr (UnknownSizeStructure<T>)
+            return decodeUnknownSizePacket(packetArray);
+        else
+            return std::unexpected(EventError::ParseError);
+    }
+
+    std::expected<T, EventError> decodeFixedSizePacket(QByteArrayView packetArray) const
+        requires FixedSizeStructure<T>
+    {
+        if (std::cmp_less(packetArray.size(), T::Layout::size()))
             return std::unexpected(EventError::NotEnoughBytes);
 
-        for (quint32 xyCounter = 0; xyCounter < T::arrayLimit(); ++xyCounter)
-        {
-            const auto mayBeSignaturePos = T::fixedPartSize() + xyCounter * T::arrayPartSize();
-            const auto mayBePacketEnd = mayBeSignaturePos + static_cast<int>(T::signature().size()) + static_cast<int>(sizeof(quint16));
-            if (packetArray.size() < mayBePacketEnd)
-                return std::unexpected(EventError::NotEnoughBytes);
-
-            if (packetArray.sliced(mayBeSignaturePos, T::signature().size()) != T::signature())
-                continue;
-
-            const QByteArray copy = packetArray.toByteArray();
-            const auto checksum = calculateChecksum(copy.chopped(sizeof(quint16)));
-
-            QDataStream stream(copy);
-            stream.setByteOrder(QDataStream::LittleEndian);
-
-            T packet{};
-            packet.deserialize(stream, xyCounter);
-
-            if (packet.deviceId != m_deviceId)
-            {
-                qWarning() << "Invalid device ID in packet. Expected:" << m_deviceId << "Received:" << packet.deviceId;
-                qWarning() << "Packet array:" << copy.toHex();
-                return std::unexpected(EventError::InvalidDeviceId);
-            }
-
-            if (packet.packetType != m_packetType)
-            {
-                qWarning() << "Unsupported packet type. Expected:" << static_cast<int>(m_packetType) << "Received:" << static_cast<int>(packet.packetType);
-                qWarning() << "Packet array:" << copy.toHex();
-                return std::unexpected(EventError::UnsupportedPacketType);
-            }
-
-            if (packet.checksum != checksum)
-            {
-                qWarning() << "Checksum mismatch in packet. Expected:" << checksum << "Received:" << packet.checksum;
-                qWarning() << "Packet array:" << copy.toHex();
-                return std::unexpected(EventError::ChecksumMismatch);
-            }
-
-            return std::make_pair(packet, copy);
-        }
+        const auto packetView = packetArray.first(static_cast<qsizetype>(T::Layout::size()));
+        const auto checksum = calculateChecksum(packetView.chopped(sizeof(quint16)));
+
+        T packet{};
+        T::Layout::decode(reinterpret_cast<const uchar *>(packetView.constData()), packet);
+
+        if (const auto error = validate(packet, checksum))
+            return reject(*error, packetView);
+
+        return packet;
+    }
+
+    std::expected<T, EventError> decodeKnownSizePacket(QByteArrayView packetArray) const
+        requires KnownSizeStructure<T>
+    {
+        if (std::cmp_less(packetArray.size(), T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        const auto arrayLength = qFromLittleEndian<quint32>(packetArray.constData() + T::arrayLengthOffset());
+        const auto paddingLength = qFromLittleEndian<quint16>(packetArray.constData() + T::paddingLengthOffset());
+        const quint64 checksumOffset = static_cast<quint64>(T::fixedPartSize()) + static_cast<quint64>(arrayLength) * static_cast<quint64>(T::arrayItemSize());
+        const quint64 totalSize = checksumOffset + sizeof(quint16) + static_cast<quint64>(paddingLength) * sizeof(qint16);
+
+        if (std::cmp_less(packetArray.size(), totalSize))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        const auto packetView = packetArray.first(static_cast<qsizetype>(totalSize));
+        const auto checksum = calculateChecksum(packetView.first(static_cast<qsizetype>(checksumOffset)));
 
-        qWarning() << "No valid packet found in buffer. Device ID:" << m_deviceId << "Packet type:" << static_cast<int>(m_packetType);
-        return std::unexpected(EventError::ParseError);
+        LittleEndianReader reader(packetView);
+
+        T packet{};
+        packet.deserialize(reader);
+
+        if (reader.status() != LittleEndianReader::Status::Ok)
+            return reject(EventError::ParseError, packetView);
+
+        if (const auto error = validate(packet, checksum))
+            return reject(*error, packetView);
+
+        return packet;
+    }
+
+    std::expected<T, EventError> decodeUnknownSizePacket(QByteArrayView packetArray) const
+        requires UnknownSizeStructure<T>
+    {
+        const auto located = locateUnknownSizePacket(packetArray);
+        if (!located)
+            return std::unexpected(located.error());
+
+        return decodeLocated(located->view, located->arrayCount);
+    }
+
+    quint32 deviceId() const
+    {
+        return m_deviceId;
     }
 
     EventPacketType packetType() const
@@ -268,7 +338,78 @@ template <typename T> class PacketParser final
         return m_packetType;
     }
 
+    // Only runs for rejected packets; ParseDiagnostics::device() finds the counters without locking.
+    void recordError(EventError error, QByteArrayView packetArray) const
+    {
+        auto &diagnostics = ParseDiagnostics::instance();
+        diagnostics.record(diagnostics.device(m_deviceId), m_deviceId, m_packetType, error, packetArray);
+    }
+
   private:
+    struct LocatedPacket
+    {
+        QByteArrayView view;
+        quint32 arrayCount{};
+    };
+
+    // Finds the end of an unknown-size packet by its trailing signature.
+    std::expected<LocatedPacket, EventError> locateUnknownSizePacket(QByteArrayView packetArray) const
+        requires UnknownSizeStructure<T>
+    {
+        if (std::cmp_less(packetArray.size(), T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        static constexpr SignatureScanner scanner(T::signatureBytes);
+        const auto scan = scanner.scan(packetArray, T::fixedPartSize(), T::arrayPartSize(), T::arrayLimit());
+
+        if (scan.status == SignatureScanResult::Status::NeedMoreData)
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        if (scan.status == SignatureScanResult::Status::NotFound)
+            return reject(EventError::ParseError, packetArray);
+
+        const auto arrayCount = static_cast<quint32>(scan.index);
+        const quint64 packetEnd = static_cast<quint64>(T::fixedPartSize()) + static_cast<quint64>(arrayCount) * T::arrayPartSize() + T::signatureBytes.size() + sizeof(quint16);
+
+        return LocatedPacket{packetArray.first(static_cast<qsizetype>(packetEnd)), arrayCount};
+    }
+
+    std::expected<T, EventError> decodeLocated(QByteArrayView packetView, quint32 arrayCount) const
+        requires UnknownSizeStructure<T>
+    {
+        const auto checksum = calculateChecksum(packetView.chopped(sizeof(quint16)));
+
+        LittleEndianReader reader(packetView);
+
+        T packet{};
+        packet.deserialize(reader, arrayCount);
+
+        if (const auto error = validate(packet, checksum))
+            return reject(*error, packetView);
+
+        return packet;
+    }
+
+    std::optional<EventError> validate(const T &packet, quint16 checksum) const
+    {
+        if (packet.deviceId != m_deviceId)
+            return EventError::InvalidDeviceId;
+
+        if (packet.packetType != m_packetType)
+            return EventError::UnsupportedPacketType;
+
+        if (packet.checksum != checksum)
+            return EventError::ChecksumMismatch;
+
+        return std::nullopt;
+    }
+
+    std::unexpected<EventError> reject(EventError error, QByteArrayView packetArray) const
+    {
+        recordError(error, packetArray);
+        return std::unexpected(error);
+    }
+
     quint32 m_deviceId{};
     EventPacketType m_packetType{};
 };
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "spscqueue.h"
+#include "threadplacement.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Process-wide work-stealing executor for parse jobs.
+ *
+ * One thread per hardware thread (per parser core of the NIC's node under a
+ * ThreadPlacement policy) serves the parser workers of every PacketBuffer, so the thread count does not grow with devices, packet
+ * types or pool sizes. Each thread owns a lane; a task is queued on the lane
+ * its affinity key hashes to, the owner takes tasks from the front and idle
+ * threads steal from the back of other lanes. Threads with nothing to run
+ * or steal park on a condition variable; submit() only touches it when
+ * somebody is parked.
+ *
+ * Fairness comes from the tasks: a worker drain runs a bounded quantum and
+ * then resubmits itself to the back of a lane, so one saturated device or
+ * packet type cannot starve the others.
+ *
+ * The shared instance() is never destroyed, so no thread is joined during
+ * static destruction while its tasks may still reach other singletons. The
+ * application calls instance().shutdown() once its pipelines have stopped
+ * and before main() returns; afterwards submit() refuses tasks and callers
+ * run the work themselves.
+ */
+
+struct ParserExecutorStats
+{
+    int threads{};
+    quint64 executed{};
+    quint64 stolen{};
+    quint64 parked{};
+};
+
+class ParserExecutor final
+{
+  public:
+    using Task = std::function<void()>;
+
+    explicit ParserExecutor(int threadCount = 0)
+    {
+        const int placedCount = ThreadPlacement::instance().parserThreadCount();
+        const int count = threadCount > 0 ? threadCount : placedCount > 0 ? placedCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        m_lanes.reserve(count);
+        for (int i = 0; i < count; ++i)
+            m_lanes.push_back(std::make_unique<Lane>());
+
+        m_threads.reserve(count);
+        for (int i = 0; i < count; ++i)
+            m_threads.emplace_back([this, i] { run(i); });
+    }
+
+    ParserExecutor(const ParserExecutor &) = delete;
+    ParserExecutor &operator=(const ParserExecutor &) = delete;
+
+    ~ParserExecutor()
+    {
+        shutdown();
+    }
+
+    static ParserExecutor &instance()
+    {
+        static auto *executor = new ParserExecutor;
+        return *executor;
+    }
+
+    /*
+     * Runs the queued tasks to completion, joins the threads and refuses
+     * further tasks. Tasks queued while the threads exit run on the calling
+     * thread. Must not be called from an executor thread; later calls return
+     * at once.
+     */
+    void shutdown()
+    {
+        std::lock_guard shutdownLock(m_shutdownMutex);
+        if (m_closed)
+            return;
+
+        {
+            std::lock_guard lock(m_parkMutex);
+            m_stopping = true;
+        }
+        m_parkCondition.notify_all();
+
+        for (auto &thread : m_threads)
+            thread.join();
+
+        for (auto &lane : m_lanes)
+        {
+            std::lock_guard lock(lane->mutex);
+            lane->closed = true;
+        }
+
+        m_closed = true;
+        for (Task task; take(0, task); task = nullptr)
+        {
+            task();
+            m_executed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    int threadCount() const
+    {
+        return static_cast<int>(m_threads.size());
+    }
+
+    /*
+     * Queues task on the lane of affinityKey; a task submitted from an
+     * executor thread goes to that thread's lane. Returns false, leaving task
+     * to the caller, once shutdown() has closed the lanes.
+     */
+    [[nodiscard]] bool submit(Task task, size_t affinityKey = 0)
+    {
+        const auto lane = currentLane() >= 0 ? static_cast<size_t>(currentLane()) : affinityKey % m_lanes.size();
+
+        {
+            std::lock_guard lock(m_lanes[lane]->mutex);
+            if (m_lanes[lane]->closed)
+                return false;
+
+            m_lanes[lane]->tasks.push_back(std::move(task));
+        }
+
+        m_queued.fetch_add(1);
+        if (m_parkedThreads.load() > 0)
+        {
+            std::lock_guard lock(m_parkMutex);
+            m_parkCondition.notify_one();
+        }
+
+        return true;
+    }
+
+    ParserExecutorStats stats() const
+    {
+        return {threadCount(), m_executed.load(std::memory_order_relaxed), m_stolen.load(std::memory_order_relaxed), m_parked.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    struct alignas(cacheLineSize) Lane
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        bool closed{false};
+    };
+
+    static int &currentLane()
+    {
+        static thread_local int lane = -1;
+        return lane;
+    }
+
+    void run(int index)
+    {
+        currentLane() = index;
+        ThreadPlacement::instance().pinCurrentThread(ThreadRole::Parser);
+
+        Task task;
+        for (;;)
+        {
+            if (take(index, task))
+            {
+                task();
+                task = nullptr;
+                m_executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::unique_lock lock(m_parkMutex);
+            if (m_stopping)
+                return;
+
+            m_parkedThreads.fetch_add(1);
+            m_parked.fetch_add(1, std::memory_order_relaxed);
+            m_parkCondition.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+            m_parkedThreads.fetch_sub(1);
+
+            if (m_stopping && m_queued.load() == 0)
+                return;
+        }
+    }
+
+    bool take(int index, Task &task)
+    {
+        if (m_queued.load() == 0)
+            return false;
+
+        {
+            auto &own = *m_lanes[index];
+            std::lock_guard lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.front());
+                own.tasks.pop_front();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        const auto laneCount = m_lanes.size();
+        for (size_t step = 1; step < laneCount; ++step)
+        {
+            auto &victim = *m_lanes[(index + step) % laneCount];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+                m_queued.fetch_sub(1);
+                m_stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<qint64> m_queued{};
+    std::atomic<int> m_parkedThreads{};
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCondition;
+    bool m_stopping{false};
+
+    std::mutex m_shutdownMutex;
+    bool m_closed{false};
+
+    std::atomic<quint64> m_executed{};
+    std::atomic<quint64> m_stolen{};
+    std::atomic<quint64> m_parked{};
+};
+
+} // namespace network
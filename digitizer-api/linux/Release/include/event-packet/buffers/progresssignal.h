@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace network
+{
+
+/*
+ * Wakes a stalled producer when a consumer makes progress.
+ *
+ * The producer reads epoch() before it tries, and if the attempt fails,
+ * waits with waitUntil() for the epoch to move. notify() bumps the epoch and
+ * only takes the mutex while somebody waits, so consumers pay one atomic
+ * increment per call when nobody is stalled. Progress made between the
+ * producer's attempt and its wait is not lost: the wait returns at once.
+ */
+
+class ProgressSignal final
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    quint64 epoch() const
+    {
+        return m_epoch.load();
+    }
+
+    void notify()
+    {
+        m_epoch.fetch_add(1);
+
+        // Pairs with the waiter count taken in waitUntil(): either the waiter sees the new epoch or this sees the waiter.
+        if (m_waiters.load() > 0)
+        {
+            std::lock_guard lock(m_mutex);
+            m_condition.notify_all();
+        }
+    }
+
+    // Waits until the epoch differs from seen or deadline passes; returns whether it moved.
+    bool waitUntil(quint64 seen, Clock::time_point deadline)
+    {
+        m_waiters.fetch_add(1);
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait_until(lock, deadline, [&] { return m_epoch.load() != seen; });
+        }
+        m_waiters.fetch_sub(1);
+
+        return m_epoch.load() != seen;
+    }
+
+  private:
+    std::atomic<quint64> m_epoch{};
+    std::atomic<int> m_waiters{};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+} // namespace network
@@ -0,0 +1,640 @@
+#pragma once
+
+#include "eventcolumnssink.h"
+#include "framingstage.h"
+#include "ioreactorgroup.h"
+#include "iouringingest.h"
+#include "networkpacket.h"
+#include "parserconcurrency.h"
+#include "pipelinelimits.h"
+#include "reorderwindow.h"
+#include "slabpool.h"
+#include "sliceindex.h"
+#include "slicepairworker.h"
+#include "sliceparserworker.h"
+#include "threadplacement.h"
+
+#include <QIODevice>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Receive path of one device built on the slice workers: slab reads,
+ * framing, parser pools, reorder window and delivery.
+ *
+ * The I/O side hands received bytes to the pipeline with readFrom() or
+ * append() (one thread, as SlabPool requires), passes finished slab chunks
+ * to push(), or gives the socket to an IoUringIngest or an IoReactorGroup
+ * with adoptSocket(). The pipeline's framing thread runs a FramingStage over
+ * the chunks, so every packet is located by the SliceIndexer once, and
+ * routes the slices by packet type: single-type pools get one job per
+ * slice, info/waveform pools one job per pair with matching rtc. Each pool
+ * has a ParserConcurrencyController (see ParserConcurrency), so jobs go
+ * round robin over the pool's active workers only and the active set
+ * follows the load. Pools of fixed-size packets may instead be parsed
+ * inline on the framing thread, as the controller's ParseMode decides; the
+ * results still pass the reorder window. The framing thread is the single producer of every
+ * worker ring; when a worker is full it waits in SliceWorker::waitForRoom()
+ * and reads no input meanwhile, so a full ParserQueue budget holds up the
+ * socket reads through the SocketRead budget of the slab pool.
+ *
+ * Parsed packets come back through the device's ReorderWindow in stream
+ * order, wait in the ParsedPending stage and are handed to the batch
+ * callback on the framing thread, errors after the batch they arrived with.
+ * Without a reorder window (ReorderWindows policy disabled) packets are
+ * delivered in completion order.
+ *
+ * With a column sink (setColumnSink()) PSD and PHA packets skip the
+ * workers and are decoded into column batches on the framing thread.
+ *
+ * Parsers are added before start(). PacketBuffer keeps its own framing and
+ * PacketParserWorker threads; this pipeline is only used by code that opts
+ * in to the slice workers. Owners stop their pipelines before calling
+ * ParserExecutor::instance().shutdown().
+ */
+
+struct ReceivePipelineOptions
+{
+    int poolSize{4}; // workers per parser pool
+    int slabSize{4 * 1024 * 1024};
+    int maxPacketSize{4 * 1024 * 1024}; // larger announced sizes count as corruption; set to the largest packet the device sends
+    std::chrono::nanoseconds tick{std::chrono::milliseconds(5)}; // reorder timeout checks and delivery while idle
+};
+
+struct ReceivePipelineStats
+{
+    quint32 deviceId{};
+    FramingStats framing;
+    quint64 slabsAllocated{}; // receive slabs; in steady state reads reuse them
+    quint64 slabsReused{};
+    quint64 unroutedSlices{}; // slices of a type no parser was added for
+    quint64 droppedJobs{};    // discarded by the ParserQueue budget
+    quint64 deliveredPackets{};
+    quint64 columnPackets{}; // decoded into column batches
+    quint64 parseErrors{};
+    quint64 droppedPackets{}; // discarded by the ParsedPending budget
+};
+
+class ReceivePipeline final
+{
+  public:
+    using Clock = ProgressSignal::Clock;
+    using BatchCallback = std::function<void(const NetworkPacketBatch &)>;
+    using ErrorCallback = std::function<void(EventError, EventPacketType)>;
+
+    explicit ReceivePipeline(quint32 deviceId, const ReceivePipelineOptions &options = {})
+        : m_deviceId(deviceId), m_options(options), m_framing(deviceId), m_slabs(SlabPool::create(options.slabSize))
+    {
+        auto &limits = PipelineLimits::instance();
+        m_slabs->setBudget(limits.budget(deviceId, PipelineStage::SocketRead));
+        m_queueBudget = limits.budget(deviceId, PipelineStage::ParserQueue);
+        m_parsedBudget = limits.budget(deviceId, PipelineStage::ParsedPending);
+        m_window = ReorderWindows::instance().attach(deviceId, [this](ParsedSlice &slice) { collect(slice); });
+        m_framing.setMaxPacketSize(options.maxPacketSize);
+    }
+
+    ~ReceivePipeline()
+    {
+        {
+            std::lock_guard lock(m_feed->mutex);
+            m_feed->pipeline = nullptr;
+        }
+
+        stop();
+    }
+
+    ReceivePipeline(const ReceivePipeline &) = delete;
+    ReceivePipeline &operator=(const ReceivePipeline &) = delete;
+
+    template <NetworkPacketAlternative T> void addParser(EventPacketType type)
+    {
+        if constexpr (ColumnarPacket<T>)
+        {
+            if (m_columnSink)
+            {
+                addColumnRoute<T>(type);
+                return;
+            }
+        }
+
+        int inlinePacketSize = 0;
+        if constexpr (FixedSizeStructure<T>)
+            inlinePacketSize = static_cast<int>(T::size());
+
+        auto &pool = addPool(type, EventPacketType::InvalidEventInfo, inlinePacketSize);
+        for (int i = 0; i < pool.size; ++i)
+        {
+            auto parser = std::make_unique<PacketParser<T>>(type);
+            parser->setDeviceId(m_deviceId);
+            addWorker(pool, std::make_unique<SliceParserWorker<T>>(std::move(parser)));
+        }
+    }
+
+    template <NetworkPacketAlternative InfoT, NetworkPacketAlternative WaveT> void addParserPair(EventPacketType infoType, EventPacketType waveType)
+    {
+        auto &pool = addPool(infoType, waveType);
+        for (int i = 0; i < pool.size; ++i)
+        {
+            auto infoParser = std::make_unique<PacketParser<InfoT>>(infoType);
+            auto waveParser = std::make_unique<PacketParser<WaveT>>(waveType);
+            infoParser->setDeviceId(m_deviceId);
+            waveParser->setDeviceId(m_deviceId);
+            addWorker(pool, std::make_unique<SlicePairWorker<InfoT, WaveT>>(std::move(infoParser), std::move(waveParser)));
+        }
+    }
+
+    /*
+     * Columnar delivery (see EventColumnsSink): PSD and PHA types added
+     * afterwards are decoded with PacketParser::parseInto() on the framing
+     * thread, in stream order, into one open batch per type instead of going
+     * to a worker pool. Batches are published to sink from the framing
+     * thread when full, when due on a tick and when the pipeline stops.
+     */
+    void setColumnSink(std::shared_ptr<EventColumnsSink> sink)
+    {
+        m_columnSink = std::move(sink);
+    }
+
+    // Called on the framing thread; set before start().
+    void setBatchCallback(BatchCallback callback)
+    {
+        m_batchCallback = std::move(callback);
+    }
+
+    void setErrorCallback(ErrorCallback callback)
+    {
+        m_errorCallback = std::move(callback);
+    }
+
+    void start()
+    {
+        if (m_thread.joinable())
+            return;
+
+        m_stopping = false;
+        m_thread = std::thread([this] { run(); });
+    }
+
+    // Frames what was pushed so far, waits for the workers and delivers the rest.
+    void stop()
+    {
+        {
+            std::lock_guard lock(m_inputMutex);
+            m_stopping = true;
+        }
+        m_inputReady.notify_one();
+
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void push(SlabPool::Chunk &&chunk)
+    {
+        {
+            std::lock_guard lock(m_inputMutex);
+            m_input.push_back(std::move(chunk));
+        }
+        m_inputReady.notify_one();
+    }
+
+    // Reads what device has available into slabs; see SlabPool::readFrom() for pausing.
+    qint64 readFrom(QIODevice *device)
+    {
+        return m_slabs->readFrom(device, [this](SlabPool::Chunk chunk) { push(std::move(chunk)); });
+    }
+
+    // Copies bytes received into a buffer of the caller's into a slab.
+    SlabPool::AppendResult append(QByteArrayView bytes)
+    {
+        SlabPool::Chunk chunk;
+        const auto result = m_slabs->append(bytes, chunk);
+        if (result == SlabPool::AppendResult::Stored)
+            push(std::move(chunk));
+
+        return result;
+    }
+
+    /*
+     * Hands a connected data socket to ingest, which reads it into this
+     * pipeline's slabs and pushes the chunks from its own thread; false where
+     * io_uring is not available, in which case the caller still owns the
+     * descriptor. onClosed runs on the ingest thread. Chunks that arrive
+     * after the pipeline was destroyed are dropped.
+     */
+    bool adoptSocket(IoUringIngest &ingest, int descriptor, IoUringIngest::CloseHandler onClosed = {})
+    {
+        return ingest.adopt(descriptor, m_slabs, feeder(), std::move(onClosed));
+    }
+
+    // Hands a connected data socket to the least loaded reactor of group; returns its index, or -1 if it was refused.
+    int adoptSocket(IoReactorGroup &group, qintptr descriptor, IoReactor::CloseHandler onClosed = {})
+    {
+        return group.assign(m_deviceId, descriptor, m_slabs, feeder(), std::move(onClosed));
+    }
+
+    // For the resume handler of a paused reader.
+    SlabPool &slabPool()
+    {
+        return *m_slabs;
+    }
+
+    ReceivePipelineStats stats() const
+    {
+        return {m_deviceId,
+                m_framing.stats(),
+                m_slabs->slabsAllocated(),
+                m_slabs->slabsReused(),
+                m_unroutedSlices.load(std::memory_order_relaxed),
+                m_droppedJobs.load(std::memory_order_relaxed),
+                m_deliveredPackets.load(std::memory_order_relaxed),
+                m_columnPackets.load(std::memory_order_relaxed),
+                m_parseErrors.load(std::memory_order_relaxed),
+                m_droppedPackets.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    struct WorkerPool
+    {
+        EventPacketType infoType{EventPacketType::InvalidEventInfo};
+        EventPacketType waveType{EventPacketType::InvalidEventInfo}; // InvalidEventInfo for single-type pools
+        int size{};
+        std::shared_ptr<ParserConcurrencyController> concurrency;
+        std::vector<std::unique_ptr<SliceWorker>> owned;
+        std::vector<SliceWorker *> workers;
+        int nextIndex{};
+
+        bool isPair() const
+        {
+            return waveType != EventPacketType::InvalidEventInfo;
+        }
+    };
+
+    // How reader threads reach the pipeline; cleared by the destructor.
+    struct Feed
+    {
+        explicit Feed(ReceivePipeline *target) : pipeline(target)
+        {
+        }
+
+        std::mutex mutex;
+        ReceivePipeline *pipeline;
+    };
+
+    IoUringIngest::ChunkHandler feeder()
+    {
+        return [feed = m_feed](SlabPool::Chunk &&chunk) {
+            std::lock_guard lock(feed->mutex);
+            if (feed->pipeline)
+                feed->pipeline->push(std::move(chunk));
+        };
+    }
+
+    struct PendingError
+    {
+        EventError error;
+        EventPacketType type;
+    };
+
+    // The open column batch of a type routed to the column sink.
+    class ColumnRoute
+    {
+      public:
+        virtual ~ColumnRoute() = default;
+        virtual std::expected<void, EventError> decode(QByteArrayView packet) = 0;
+        virtual void publish(EventColumnsSink &sink, bool dueOnly) = 0;
+    };
+
+    template <ColumnarPacket T> class ColumnRouteFor final : public ColumnRoute
+    {
+      public:
+        ColumnRouteFor(quint32 deviceId, EventPacketType type, size_t batchEvents) : m_parser(type)
+        {
+            m_parser.setDeviceId(deviceId);
+            m_batch.columns.deviceId = deviceId;
+            m_batch.columns.packetType = type;
+            m_batch.columns.reserve(batchEvents);
+        }
+
+        std::expected<void, EventError> decode(QByteArrayView packet) override
+        {
+            if (m_batch.columns.empty())
+                m_batch.opened = std::chrono::steady_clock::now();
+
+            return m_parser.parseInto(packet, m_batch.columns);
+        }
+
+        void publish(EventColumnsSink &sink, bool dueOnly) override
+        {
+            if (!dueOnly || m_batch.isDue(sink.policy()))
+                sink.publish(m_batch.columns);
+        }
+
+      private:
+        PacketParser<T> m_parser;
+        ColumnBatch<ColumnsOf<T>> m_batch;
+    };
+
+    template <ColumnarPacket T> void addColumnRoute(EventPacketType type)
+    {
+        auto &route = m_columnRoutes.emplace_back(std::make_unique<ColumnRouteFor<T>>(m_deviceId, type, m_columnSink->policy().batchEvents));
+        m_columnRouteOf[static_cast<quint8>(type)] = route.get();
+    }
+
+    WorkerPool &addPool(EventPacketType infoType, EventPacketType waveType, int inlinePacketSize = 0)
+    {
+        auto &pool = *m_pools.emplace_back(std::make_unique<WorkerPool>());
+        pool.infoType = infoType;
+        pool.waveType = waveType;
+        pool.size = std::max(m_options.poolSize, 1);
+        pool.concurrency = ParserConcurrency::instance().attach(m_deviceId, infoType, waveType, pool.size, inlinePacketSize);
+
+        m_routes[static_cast<quint8>(infoType)] = &pool;
+        if (pool.isPair())
+            m_routes[static_cast<quint8>(waveType)] = &pool;
+
+        return pool;
+    }
+
+    void addWorker(WorkerPool &pool, std::unique_ptr<SliceWorker> worker)
+    {
+        worker->setQueueBudget(m_queueBudget);
+        worker->setReorderWindow(m_window);
+        worker->setResultHandler([this](ParsedSlice &slice) { collect(slice); });
+        worker->setConcurrency(pool.concurrency);
+
+        pool.workers.push_back(worker.get());
+        pool.owned.push_back(std::move(worker));
+    }
+
+    void run()
+    {
+        ThreadPlacement::instance().pinCurrentThread(ThreadRole::Framing);
+
+        m_nextTick = Clock::now() + m_options.tick;
+        std::deque<SlabPool::Chunk> chunks;
+        for (;;)
+        {
+            {
+                std::unique_lock lock(m_inputMutex);
+                m_inputReady.wait_until(lock, m_nextTick, [this] { return !m_input.empty() || m_parsedReady || m_stopping; });
+                chunks.swap(m_input);
+                m_parsedReady = false;
+
+                if (m_stopping && chunks.empty())
+                    break;
+            }
+
+            for (const auto &chunk : chunks)
+                m_framing.push(chunk, [this](const QSharedPointer<QByteArray> &buffer, const SliceIndex &index) { dispatch(buffer, index); });
+            chunks.clear();
+
+            deliver();
+            if (Clock::now() >= m_nextTick)
+                tick();
+        }
+
+        finish();
+    }
+
+    void dispatch(const QSharedPointer<QByteArray> &buffer, const SliceIndex &index)
+    {
+        const auto &slices = index.slices;
+        const auto count = static_cast<qsizetype>(slices.size());
+
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            const auto &slice = slices[i];
+            if (auto *columns = m_columnRouteOf[static_cast<quint8>(slice.type)])
+            {
+                decodeColumns(*columns, QByteArrayView(buffer->constData() + slice.offset, slice.length), slice.type);
+                continue;
+            }
+
+            auto *pool = m_routes[static_cast<quint8>(slice.type)];
+            if (!pool)
+            {
+                m_unroutedSlices.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            SliceJob job{buffer, slice.offset, slice.length};
+            if (pool->isPair())
+            {
+                if (startsPair(slices, i, pool->infoType, pool->waveType))
+                {
+                    const auto &wave = slices[++i];
+                    job.pairOffset = wave.offset;
+                    job.pairLength = wave.length;
+                }
+                else if (slice.type == pool->waveType)
+                {
+                    job = SliceJob{buffer, -1, 0, slice.offset, slice.length};
+                }
+            }
+
+            if (pool->isPair())
+                offer(*pool->workers[nextWorkerIndex(pool->workers, pool->nextIndex)], job);
+            else
+                dispatchSlice(pool->workers, pool->nextIndex, std::move(job), [this](SliceWorker &worker, SliceJob &&job) { offer(worker, job); });
+        }
+    }
+
+    void offer(SliceWorker &worker, SliceJob &job)
+    {
+        for (;;)
+        {
+            switch (worker.trySubmit(job))
+            {
+            case SliceWorker::Intake::Queued:
+                return;
+            case SliceWorker::Intake::Dropped:
+                m_droppedJobs.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case SliceWorker::Intake::Full:
+                // Keep delivering and skipping lost sequence numbers while the worker is full.
+                if (!worker.waitForRoom(m_nextTick))
+                    tick();
+                break;
+            }
+        }
+    }
+
+    void decodeColumns(ColumnRoute &route, QByteArrayView packet, EventPacketType type)
+    {
+        const auto result = route.decode(packet);
+        if (!result)
+        {
+            std::lock_guard lock(m_parsedMutex);
+            m_errors.push_back({result.error(), type});
+            return;
+        }
+
+        m_columnPackets.fetch_add(1, std::memory_order_relaxed);
+        route.publish(*m_columnSink, true);
+    }
+
+    // Called by the reorder window or, without one, by the workers.
+    void collect(ParsedSlice &slice)
+    {
+        bool wasEmpty = false;
+        {
+            std::lock_guard lock(m_parsedMutex);
+            wasEmpty = m_parsed.empty() && m_errors.empty();
+
+            for (quint8 i = 0; i < slice.count; ++i)
+            {
+                auto &emission = slice.emissions[i];
+                if (emission.error)
+                    m_errors.push_back({*emission.error, emission.type});
+                else if (!pushBounded(m_parsed, std::move(emission.packet), *m_parsedBudget, packetBytes, isWaveformPacket))
+                    m_droppedPackets.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (wasEmpty)
+        {
+            {
+                std::lock_guard lock(m_inputMutex);
+                m_parsedReady = true;
+            }
+            m_inputReady.notify_one();
+        }
+    }
+
+    void deliver()
+    {
+        {
+            std::lock_guard lock(m_parsedMutex);
+            if (m_parsed.empty() && m_errors.empty())
+                return;
+
+            m_batch.reserve(m_parsed.size());
+            for (auto &packet : m_parsed)
+            {
+                m_parsedBudget->release(packetBytes(packet));
+                m_batch.push_back(std::move(packet));
+            }
+            m_parsed.clear();
+            m_deliveringErrors.swap(m_errors);
+        }
+
+        m_deliveredPackets.fetch_add(m_batch.size(), std::memory_order_relaxed);
+        m_parseErrors.fetch_add(m_deliveringErrors.size(), std::memory_order_relaxed);
+
+        if (m_batchCallback && !m_batch.empty())
+            m_batchCallback(m_batch);
+
+        if (m_errorCallback)
+        {
+            for (const auto &[error, type] : m_deliveringErrors)
+                m_errorCallback(error, type);
+        }
+
+        m_batch.clear();
+        m_deliveringErrors.clear();
+    }
+
+    void tick()
+    {
+        if (m_window)
+            m_window->flushExpired();
+
+        deliver();
+        publishColumns(true);
+        m_nextTick = Clock::now() + m_options.tick;
+    }
+
+    void publishColumns(bool dueOnly)
+    {
+        for (const auto &route : m_columnRoutes)
+            route->publish(*m_columnSink, dueOnly);
+    }
+
+    void finish()
+    {
+        // An incomplete packet at the end of the stream never completes.
+        m_framing.discard(m_framing.pendingBytes());
+
+        const auto isIdle = [](const SliceWorker *worker) { return worker->isIdle(); };
+        for (;;)
+        {
+            const bool idle = std::ranges::all_of(m_pools, [&](const auto &pool) { return std::ranges::all_of(pool->workers, isIdle); });
+
+            tick();
+            if (idle)
+            {
+                publishColumns(false);
+                break;
+            }
+
+            std::unique_lock lock(m_inputMutex);
+            m_inputReady.wait_for(lock, std::chrono::milliseconds(1), [this] { return m_parsedReady; });
+            m_parsedReady = false;
+        }
+    }
+
+    static bool isWaveformPacket(const NetworkPacket &packet)
+    {
+        return std::holds_alternative<WaveformNetworkPacket>(packet);
+    }
+
+    const quint32 m_deviceId;
+    const ReceivePipelineOptions m_options;
+
+    FramingStage m_framing;
+    std::shared_ptr<SlabPool> m_slabs;
+    std::shared_ptr<StageBudget> m_queueBudget;
+    std::shared_ptr<StageBudget> m_parsedBudget;
+    std::shared_ptr<ReorderWindow> m_window;
+
+    BatchCallback m_batchCallback;
+    ErrorCallback m_errorCallback;
+    std::shared_ptr<EventColumnsSink> m_columnSink;
+    std::shared_ptr<Feed> m_feed = std::make_shared<Feed>(this);
+
+    std::mutex m_inputMutex;
+    std::condition_variable m_inputReady;
+    std::deque<SlabPool::Chunk> m_input;
+    bool m_parsedReady{false};
+    bool m_stopping{false};
+
+    std::mutex m_parsedMutex;
+    std::deque<NetworkPacket> m_parsed;
+    std::vector<PendingError> m_errors;
+
+    // Framing thread only.
+    std::array<WorkerPool *, 256> m_routes{};
+    std::array<ColumnRoute *, 256> m_columnRouteOf{};
+    std::vector<std::unique_ptr<ColumnRoute>> m_columnRoutes;
+    Clock::time_point m_nextTick;
+    NetworkPacketBatch m_batch;
+    std::vector<PendingError> m_deliveringErrors;
+    std::thread m_thread;
+
+    std::atomic<quint64> m_unroutedSlices{};
+    std::atomic<quint64> m_droppedJobs{};
+    std::atomic<quint64> m_deliveredPackets{};
+    std::atomic<quint64> m_columnPackets{};
+    std::atomic<quint64> m_parseErrors{};
+    std::atomic<quint64> m_droppedPackets{};
+
+    // Declared last: the workers shut down before anything their results reach is destroyed.
+    std::vector<std::unique_ptr<WorkerPool>> m_pools;
+};
+
+} // namespace network
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "networkpacket.h"
+#include "packetparser.h"
+#include "progresssignal.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace network
+{
+
+class SliceWorker;
+
+/*
+ * Results of one parse job, collected so that they can be delivered later: a
+ * single slice yields one emission, an info/waveform pair up to two. A job
+ * that yields nothing (discarded on shutdown) still occupies its sequence
+ * number. Packets travel as NetworkPacket values, so nothing is boxed
+ * between the parser and the consumer.
+ */
+struct ParseEmission
+{
+    EventPacketType type{EventPacketType::InvalidEventInfo};
+    std::optional<EventError> error;
+    NetworkPacket packet;
+};
+
+struct ParsedSlice
+{
+    quint64 sequence{}; // 0 for jobs outside any reorder window
+    const SliceWorker *origin{};
+    std::array<ParseEmission, 2> emissions;
+    quint8 count{};
+
+    void parsed(NetworkPacket packet, EventPacketType type)
+    {
+        emissions[count++] = {type, std::nullopt, std::move(packet)};
+    }
+
+    void failed(EventError error, EventPacketType type)
+    {
+        emissions[count++] = {type, error, {}};
+    }
+};
+
+// Receives parsed slices; it must not call back into the window or worker that delivers them.
+using ParsedSliceHandler = std::function<void(ParsedSlice &)>;
+
+struct ReorderWindowPolicy
+{
+    bool enabled{true};
+    size_t capacity{4096}; // sequence numbers in flight per device
+    std::chrono::nanoseconds timeout{std::chrono::milliseconds(50)};
+};
+
+struct ReorderWindowStats
+{
+    quint32 deviceId{};
+    quint64 issued{};
+    quint64 released{};
+    quint64 heldBack{}; // slices that arrived before a predecessor
+    quint64 lost{};     // abandoned sequence numbers skipped after the timeout
+    quint64 late{};     // results that arrived after their number was skipped
+    quint64 windowFullWaits{};
+};
+
+/*
+ * Per-device reorder stage between the parser workers and the parsed
+ * signals.
+ *
+ * Every slice handed to a worker takes the next sequence number of its
+ * device at framing time (acquire()). Workers deposit their results in
+ * batches; a result is handed to the window's handler as soon as all lower
+ * numbers have been, otherwise it is held in a slot of a fixed ring. The
+ * handler runs under the window lock, so it sees the slices in sequence
+ * order whichever worker releases them.
+ *
+ * The ring bounds memory. acquire() never waits: the framing thread checks
+ * hasSpace() first and, while capacity numbers are in flight, waits with
+ * waitForSpace() like it does for a full parser queue. A number whose job
+ * is still queued or parsing is never given up, however long it takes, so
+ * results always leave in stream order. Only numbers the owner reports gone
+ * with abandon() are skipped, once timeout has passed since; a result that
+ * turns up for a skipped number is counted as late and discarded. Expiry is
+ * checked on deposit and by flushExpired(), which the owner calls from a
+ * timer so that a skipped number does not hold the window until the next
+ * deposit.
+ */
+class ReorderWindow final
+{
+  public:
+    ReorderWindow(quint32 deviceId, const ReorderWindowPolicy &policy, ParsedSliceHandler handler)
+        : m_deviceId(deviceId), m_capacity(std::max<size_t>(policy.capacity, 1)), m_timeout(policy.timeout), m_handler(std::move(handler)),
+          m_slots(m_capacity)
+    {
+    }
+
+    ReorderWindow(const ReorderWindow &) = delete;
+    ReorderWindow &operator=(const ReorderWindow &) = delete;
+
+    // Framing thread only, like acquire().
+    bool hasSpace() const
+    {
+        return m_issued.load(std::memory_order_relaxed) + 1 - m_next.load() < m_capacity;
+    }
+
+    // Takes the next sequence number; the caller has checked hasSpace().
+    quint64 acquire()
+    {
+        return m_issued.fetch_add(1) + 1;
+    }
+
+    // Read before hasSpace(); waitForSpace() then returns once numbers were released since.
+    quint64 spaceEpoch() const
+    {
+        return m_space.epoch();
+    }
+
+    bool waitForSpace(quint64 seen, ProgressSignal::Clock::time_point deadline)
+    {
+        return m_space.waitUntil(seen, deadline);
+    }
+
+    void countFullWait()
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_windowFullWaits;
+    }
+
+    void deposit(std::vector<ParsedSlice> &slices)
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (auto &slice : slices)
+            storeLocked(std::move(slice));
+
+        releaseLocked();
+    }
+
+    void deposit(ParsedSlice &&slice)
+    {
+        std::lock_guard lock(m_mutex);
+
+        storeLocked(std::move(slice));
+        releaseLocked();
+    }
+
+    // Reports that no result will be deposited for sequence; it is skipped once the timeout has passed.
+    void abandon(quint64 sequence)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (sequence < m_next || sequence > m_issued.load())
+            return;
+
+        auto &slot = m_slots[sequence % m_capacity];
+        if (slot.sequence != sequence)
+            m_abandoned.emplace(sequence, std::chrono::steady_clock::now() + m_timeout);
+
+        releaseLocked();
+    }
+
+    // Skips abandoned numbers whose timeout has passed and emits what they held back.
+    void flushExpired()
+    {
+        std::lock_guard lock(m_mutex);
+        releaseLocked();
+    }
+
+    // Drops the held results of a worker that is going away; their numbers are released empty.
+    void detach(const SliceWorker *origin)
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (auto &slot : m_slots)
+        {
+            if (slot.sequence != 0 && slot.origin == origin)
+                slot.count = 0;
+        }
+
+        releaseLocked();
+    }
+
+    ReorderWindowStats stats() const
+    {
+        std::lock_guard lock(m_mutex);
+        return {m_deviceId, m_issued.load(), m_released, m_heldBack, m_lost, m_late, m_windowFullWaits};
+    }
+
+  private:
+    void storeLocked(ParsedSlice &&slice)
+    {
+        if (slice.sequence < m_next)
+        {
+            ++m_late;
+            return;
+        }
+
+        if (slice.sequence != m_next)
+            ++m_heldBack;
+
+        m_abandoned.erase(slice.sequence);
+        m_slots[slice.sequence % m_capacity] = std::move(slice);
+    }
+
+    void releaseLocked()
+    {
+        const auto before = m_next.load();
+        const auto now = std::chrono::steady_clock::now();
+
+        for (;;)
+        {
+            auto &slot = m_slots[m_next % m_capacity];
+            if (slot.sequence == m_next)
+            {
+                if (m_handler)
+                    m_handler(slot);
+
+                slot = {};
+                ++m_released;
+                ++m_next;
+                continue;
+            }
+
+            const auto abandoned = m_abandoned.find(m_next);
+            if (abandoned == m_abandoned.end() || now < abandoned->second)
+                break;
+
+            m_abandoned.erase(abandoned);
+            ++m_lost;
+            ++m_next;
+        }
+
+        if (m_next != before)
+            m_space.notify();
+    }
+
+    const quint32 m_deviceId;
+    const size_t m_capacity;
+    const std::chrono::nanoseconds m_timeout;
+    const ParsedSliceHandler m_handler;
+
+    mutable std::mutex m_mutex;
+    ProgressSignal m_space;
+    std::vector<ParsedSlice> m_slots;
+    std::atomic<quint64> m_issued{}; // written by the framing thread only
+    std::atomic<quint64> m_next{1};  // written under m_mutex
+    std::map<quint64, std::chrono::steady_clock::time_point> m_abandoned; // abandoned number -> when it may be skipped
+
+    quint64 m_released{};
+    quint64 m_heldBack{};
+    quint64 m_lost{};
+    quint64 m_late{};
+    quint64 m_windowFullWaits{};
+};
+
+class ReorderWindows final
+{
+  public:
+    static ReorderWindows &instance()
+    {
+        static ReorderWindows windows;
+        return windows;
+    }
+
+    // Applies to devices whose first parser is added afterwards.
+    void setPolicy(const ReorderWindowPolicy &policy)
+    {
+        std::lock_guard lock(m_mutex);
+        m_policy = policy;
+    }
+
+    // A new window for deviceId that hands released slices to handler; nullptr if ordering is disabled.
+    std::shared_ptr<ReorderWindow> attach(quint32 deviceId, ParsedSliceHandler handler)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (!m_policy.enabled)
+            return nullptr;
+
+        auto window = std::make_shared<ReorderWindow>(deviceId, m_policy, std::move(handler));
+        m_windows[deviceId] = window;
+        return window;
+    }
+
+    std::vector<ReorderWindowStats> snapshot()
+    {
+        std::lock_guard lock(m_mutex);
+
+        std::vector<ReorderWindowStats> result;
+        for (auto it = m_windows.begin(); it != m_windows.end();)
+        {
+            if (const auto window = it->second.lock())
+            {
+                result.push_back(window->stats());
+                ++it;
+            }
+            else
+            {
+                it = m_windows.erase(it);
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    std::mutex m_mutex;
+    ReorderWindowPolicy m_policy;
+    std::map<quint32, std::weak_ptr<ReorderWindow>> m_windows;
+};
+
+} // namespace network
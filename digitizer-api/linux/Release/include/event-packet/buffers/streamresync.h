@@ -0,0 +1,216 @@
+#pragma once
+
+#include "packetchecksum.h"
+#include "packetsizeutils.h"
+#include "packets/eventpackettype.h"
+
+#include <QByteArrayView>
+#include <QtEndian>
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <expected>
+
+namespace network
+{
+
+/*
+ * Forward resynchronization after corrupted stream data.
+ *
+ * Instead of flushing everything behind a bad header, resync() scans forward
+ * for the next offset that carries a plausible packet:
+ *  - the device ID of this stream,
+ *  - a known (and accepted) EventPacketType,
+ *  - a size consistent with the type, a multiple of 8 bytes and not above
+ *    maxPacketSize(),
+ *  - a checksum that validates.
+ * Candidates are located by searching for the first byte of the device ID,
+ * so bytes that cannot start a packet are skipped at memchr speed. A
+ * candidate whose packet is not complete yet does not end the scan: a
+ * corrupted length field can announce up to maxPacketSize() bytes, and
+ * waiting for them would stall the stream while valid packets follow. The
+ * first incomplete candidate is reported (NeedMoreData) only when no later
+ * candidate validates, and the caller scans again from there once more
+ * bytes arrived. Framing resumes at the returned offset; the bytes in front
+ * of it are reported as skipped.
+ */
+
+struct ResyncResult
+{
+    enum class Status
+    {
+        Found,        // a valid packet starts at offset
+        NeedMoreData, // a plausible header starts at offset but the packet is incomplete
+        NotFound      // nothing plausible before offset; keep the bytes from offset on
+    };
+
+    Status status{Status::NotFound};
+    int offset{};
+    int skippedBytes{};
+    EventPacketType packetType{EventPacketType::InvalidEventInfo};
+    int packetSize{};
+};
+
+class StreamResync final
+{
+  public:
+    static constexpr int headerProbeSize = sizeof(quint32) + sizeof(EventPacketType);
+    static constexpr int packetAlignment = 8;
+
+    explicit StreamResync(quint32 deviceId) : m_deviceId(deviceId)
+    {
+        for (int type = 0; type < static_cast<int>(m_acceptedTypes.size()); ++type)
+            m_acceptedTypes[type] = visitPacketStructure(static_cast<EventPacketType>(type), [](auto) { return true; }).has_value();
+    }
+
+    quint32 deviceId() const
+    {
+        return m_deviceId;
+    }
+
+    // Restricts candidates to the packet types this stream actually carries.
+    void setAcceptedType(EventPacketType type, bool accepted)
+    {
+        m_acceptedTypes[static_cast<quint8>(type)] = accepted && visitPacketStructure(type, [](auto) { return true; }).has_value();
+    }
+
+    int maxPacketSize() const
+    {
+        return m_maxPacketSize;
+    }
+
+    void setMaxPacketSize(int size)
+    {
+        m_maxPacketSize = size;
+    }
+
+    quint64 resyncCount() const
+    {
+        return m_resyncCount;
+    }
+
+    quint64 skippedBytesTotal() const
+    {
+        return m_skippedBytesTotal;
+    }
+
+    // Validates the packet at offset; returns its size, NotEnoughBytes if it may still complete, or the rejection reason.
+    std::expected<int, EventError> validateAt(QByteArrayView buffer, int offset) const
+    {
+        if (buffer.size() - offset < headerProbeSize)
+        {
+            uchar deviceIdBytes[sizeof(quint32)];
+            qToLittleEndian(m_deviceId, deviceIdBytes);
+
+            const auto available = std::min<size_t>(buffer.size() - offset, sizeof(quint32));
+            if (std::memcmp(buffer.constData() + offset, deviceIdBytes, available) != 0)
+                return std::unexpected(EventError::InvalidDeviceId);
+
+            return std::unexpected(EventError::NotEnoughBytes);
+        }
+
+        if (qFromLittleEndian<quint32>(buffer.constData() + offset) != m_deviceId)
+            return std::unexpected(EventError::InvalidDeviceId);
+
+        const auto type = typeAt(buffer, offset);
+        if (!m_acceptedTypes[static_cast<quint8>(type)])
+            return std::unexpected(EventError::UnsupportedPacketType);
+
+        const auto result = visitPacketStructure(type, [&](auto structure) { return validateAs<typename decltype(structure)::type>(buffer, offset); });
+        return result.value_or(std::unexpected(EventError::UnsupportedPacketType));
+    }
+
+    ResyncResult resync(QByteArrayView buffer, int from)
+    {
+        const auto result = scan(buffer, from);
+
+        ++m_resyncCount;
+        m_skippedBytesTotal += static_cast<quint64>(result.skippedBytes);
+
+        return result;
+    }
+
+  private:
+    ResyncResult scan(QByteArrayView buffer, int from) const
+    {
+        const auto firstByte = static_cast<char>(m_deviceId & 0xFF);
+        const auto *data = buffer.constData();
+        const int size = static_cast<int>(buffer.size());
+
+        // An incomplete candidate may be a corrupted length field, so a later complete packet still wins.
+        int incomplete = -1;
+
+        int candidate = from;
+        while (candidate < size)
+        {
+            const auto *hit = static_cast<const char *>(std::memchr(data + candidate, firstByte, static_cast<size_t>(size - candidate)));
+            if (!hit)
+                break;
+
+            candidate = static_cast<int>(hit - data);
+
+            const auto packetSize = validateAt(buffer, candidate);
+            if (packetSize)
+                return {ResyncResult::Status::Found, candidate, candidate - from, typeAt(buffer, candidate), *packetSize};
+
+            if (packetSize.error() == EventError::NotEnoughBytes && incomplete < 0)
+                incomplete = candidate;
+
+            ++candidate;
+        }
+
+        if (incomplete >= 0)
+            return {ResyncResult::Status::NeedMoreData, incomplete, incomplete - from, typeAt(buffer, incomplete), 0};
+
+        return {ResyncResult::Status::NotFound, size, size - from, EventPacketType::InvalidEventInfo, 0};
+    }
+
+    static EventPacketType typeAt(QByteArrayView buffer, int offset)
+    {
+        if (buffer.size() - offset < headerProbeSize)
+            return EventPacketType::InvalidEventInfo;
+
+        return static_cast<EventPacketType>(buffer.constData()[offset + sizeof(quint32)]);
+    }
+
+    template <typename T> std::expected<int, EventError> validateAs(QByteArrayView buffer, int offset) const
+    {
+        if constexpr (KnownSizeStructure<T>)
+        {
+            // Reject absurd length fields before waiting for bytes that would never form this packet.
+            if (buffer.size() - offset >= static_cast<int>(T::fixedPartSize()) &&
+                announcedPacketSize<T>(buffer.constData() + offset) > static_cast<quint64>(m_maxPacketSize))
+                return std::unexpected(EventError::ParseError);
+        }
+
+        const auto packetSize = framedPacketSize<T>(buffer, offset);
+        if (!packetSize)
+            return packetSize;
+
+        if (*packetSize % packetAlignment != 0 || *packetSize > m_maxPacketSize)
+            return std::unexpected(EventError::ParseError);
+
+        const auto packet = buffer.sliced(offset, *packetSize);
+
+        qsizetype checksumOffset = packet.size() - static_cast<qsizetype>(sizeof(quint16));
+        if constexpr (KnownSizeStructure<T>)
+        {
+            const auto arrayLength = qFromLittleEndian<quint32>(packet.constData() + T::arrayLengthOffset());
+            checksumOffset = T::fixedPartSize() + static_cast<qsizetype>(arrayLength) * T::arrayItemSize();
+        }
+
+        if (calculateChecksum(packet.first(checksumOffset)) != qFromLittleEndian<quint16>(packet.constData() + checksumOffset))
+            return std::unexpected(EventError::ChecksumMismatch);
+
+        return *packetSize;
+    }
+
+    quint32 m_deviceId{};
+    int m_maxPacketSize{4 * 1024 * 1024};
+    std::bitset<256> m_acceptedTypes;
+    quint64 m_resyncCount{};
+    quint64 m_skippedBytesTotal{};
+};
+
+} // namespace network
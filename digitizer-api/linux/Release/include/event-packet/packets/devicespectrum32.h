@@ -1,6 +1,8 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/littleendianreader.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -28,43 +30,31 @@ namespace network
 
 struct DeviceSpectrum32
 {
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc
+        Layout::read(in, *this);
 
-            >> arrayLength >> spectrumType >> paddingLength;
-
-        for (quint32 i = 0; i < arrayLength; ++i)
-        {
-            qint32 value;
-            in >> value;
-            array.push_back(value);
-        }
+        readArray(in, array, arrayLength);
 
         in >> checksum;
-
-        for (quint16 i = 0; i < paddingLength; ++i)
-        {
-            qint16 padding;
-            in >> padding;
-        }
+        in.skipRawData(paddingLength * sizeof(qint16));
 
         return in;
     }
 
     static quint32 arrayLengthOffset()
     {
-        return offsetof(DeviceSpectrum32, arrayLength);
+        return Layout::offsetOf<&DeviceSpectrum32::arrayLength>();
     }
 
     static quint32 paddingLengthOffset()
     {
-        return offsetof(DeviceSpectrum32, paddingLength);
+        return Layout::offsetOf<&DeviceSpectrum32::paddingLength>();
     }
 
     static quint32 fixedPartSize()
     {
-        return 24;
+        return Layout::size();
     }
 
     static quint32 arrayItemSize()
@@ -84,7 +74,20 @@ struct DeviceSpectrum32
     quint16 paddingLength{};
     std::vector<qint32> array{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &DeviceSpectrum32::deviceId, 0>,
+                              WireField<"packetType", &DeviceSpectrum32::packetType, 4>,
+                              WireField<"flags", &DeviceSpectrum32::flags, 5>,
+                              WireField<"channelId", &DeviceSpectrum32::channelId, 6>,
+                              WireField<"rtc", &DeviceSpectrum32::rtc, 8>,
+                              WireField<"arrayLength", &DeviceSpectrum32::arrayLength, 16>,
+                              WireField<"spectrumType", &DeviceSpectrum32::spectrumType, 20>,
+                              WireField<"paddingLength", &DeviceSpectrum32::paddingLength, 22>>;
 };
 
+static_assert(DeviceSpectrum32::Layout::size() == 24);
+static_assert(DeviceSpectrum32::Layout::isContiguous());
+
 } // namespace network
 
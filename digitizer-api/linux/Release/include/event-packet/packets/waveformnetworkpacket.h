@@ -1,6 +1,8 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/littleendianreader.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -28,43 +30,31 @@ namespace network
 
 struct WaveformNetworkPacket
 {
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc
+        Layout::read(in, *this);
 
-            >> arrayLength >> decimationFactor >> paddingLength;
-
-        for (quint32 i = 0; i < arrayLength; ++i)
-        {
-            qint16 value;
-            in >> value;
-            array.push_back(value);
-        }
+        readArray(in, array, arrayLength);
 
         in >> checksum;
-
-        for (quint16 i = 0; i < paddingLength; ++i)
-        {
-            qint16 padding;
-            in >> padding;
-        }
+        in.skipRawData(paddingLength * sizeof(qint16));
 
         return in;
     }
 
     static quint32 arrayLengthOffset()
     {
-        return offsetof(WaveformNetworkPacket, arrayLength);
+        return Layout::offsetOf<&WaveformNetworkPacket::arrayLength>();
     }
 
     static quint32 paddingLengthOffset()
     {
-        return offsetof(WaveformNetworkPacket, paddingLength);
+        return Layout::offsetOf<&WaveformNetworkPacket::paddingLength>();
     }
 
     static quint32 fixedPartSize()
     {
-        return 24;
+        return Layout::size();
     }
 
     static quint32 arrayItemSize()
@@ -84,6 +74,19 @@ struct WaveformNetworkPacket
     quint16 paddingLength{};
     std::vector<qint16> array{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &WaveformNetworkPacket::deviceId, 0>,
+                              WireField<"packetType", &WaveformNetworkPacket::packetType, 4>,
+                              WireField<"flags", &WaveformNetworkPacket::flags, 5>,
+                              WireField<"channelId", &WaveformNetworkPacket::channelId, 6>,
+                              WireField<"rtc", &WaveformNetworkPacket::rtc, 8>,
+                              WireField<"arrayLength", &WaveformNetworkPacket::arrayLength, 16>,
+                              WireField<"decimationFactor", &WaveformNetworkPacket::decimationFactor, 20>,
+                              WireField<"paddingLength", &WaveformNetworkPacket::paddingLength, 22>>;
 };
 
+static_assert(WaveformNetworkPacket::Layout::size() == 24);
+static_assert(WaveformNetworkPacket::Layout::isContiguous());
+
 } // namespace network
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+namespace network
+{
+
+/*
+ * Compile-time description of a packet's wire format.
+ *
+ * Every packet struct declares a Layout listing its fields with their byte
+ * offset on the wire. size(), fixedPartSize(), the length-field offsets and
+ * the decoders are derived from it, and static_asserts in each struct check
+ * that the fields tile the wire header without gaps or overlaps, so the
+ * format comment, the offsets and the decoder cannot drift apart.
+ */
+
+enum class WireEndian
+{
+    Little,
+    Big
+};
+
+template <size_t N> struct WireFieldName
+{
+    constexpr WireFieldName(const char (&str)[N])
+    {
+        std::copy_n(str, N, value);
+    }
+
+    constexpr std::string_view view() const
+    {
+        return std::string_view(value, N - 1);
+    }
+
+    char value[N]{};
+};
+
+struct WireFieldInfo
+{
+    std::string_view name;
+    quint32 offset{};
+    quint32 size{};
+    WireEndian endian{WireEndian::Little};
+};
+
+namespace wire_detail
+{
+
+template <typename M> struct MemberTraits;
+
+template <typename C, typename V> struct MemberTraits<V C::*>
+{
+    using Owner = C;
+    using Value = V;
+};
+
+template <typename V> struct ScalarOf
+{
+    using type = V;
+    static constexpr size_t count = 1;
+};
+
+template <typename V, size_t N> struct ScalarOf<V[N]>
+{
+    using type = V;
+    static constexpr size_t count = N;
+};
+
+template <typename V, WireEndian Endian> V load(const uchar *data)
+{
+    if constexpr (std::is_enum_v<V>)
+        return static_cast<V>(load<std::underlying_type_t<V>, Endian>(data));
+    else if constexpr (Endian == WireEndian::Little)
+        return qFromLittleEndian<V>(data);
+    else
+        return qFromBigEndian<V>(data);
+}
+
+} // namespace wire_detail
+
+template <WireFieldName Name, auto Member, quint32 Offset, WireEndian Endian = WireEndian::Little> struct WireField
+{
+    using Owner = typename wire_detail::MemberTraits<decltype(Member)>::Owner;
+    using ValueType = typename wire_detail::MemberTraits<decltype(Member)>::Value;
+    using ScalarType = typename wire_detail::ScalarOf<ValueType>::type;
+
+    static_assert(std::is_arithmetic_v<ScalarType> || std::is_enum_v<ScalarType>, "Wire fields must be scalars or arrays of scalars");
+
+    static constexpr auto member = Member;
+    static constexpr std::string_view name = Name.view();
+    static constexpr quint32 offset = Offset;
+    static constexpr quint32 count = wire_detail::ScalarOf<ValueType>::count;
+    static constexpr quint32 size = sizeof(ScalarType) * count;
+    static constexpr WireEndian endian = Endian;
+
+    static void decode(const uchar *data, Owner &packet)
+    {
+        if constexpr (count == 1)
+        {
+            packet.*Member = wire_detail::load<ScalarType, Endian>(data + Offset);
+        }
+        else
+        {
+            for (quint32 i = 0; i < count; ++i)
+                (packet.*Member)[i] = wire_detail::load<ScalarType, Endian>(data + Offset + i * sizeof(ScalarType));
+        }
+    }
+
+    template <typename Stream> static void read(Stream &in, Owner &packet)
+    {
+        if constexpr (count == 1)
+        {
+            packet.*Member = readScalar(in);
+        }
+        else
+        {
+            for (auto &value : packet.*Member)
+                value = readScalar(in);
+        }
+    }
+
+    // Reads the raw bytes and decodes them with the field's own byte order, whatever order the stream is set to.
+    template <typename Stream> static ScalarType readScalar(Stream &in)
+    {
+        uchar bytes[sizeof(ScalarType)];
+        if (in.readRawData(reinterpret_cast<char *>(bytes), static_cast<int>(sizeof(ScalarType))) != static_cast<int>(sizeof(ScalarType)))
+            return ScalarType{};
+
+        return wire_detail::load<ScalarType, Endian>(bytes);
+    }
+};
+
+template <typename... Fields> struct WireLayout
+{
+    static_assert(sizeof...(Fields) > 0, "Wire layout must have at least one field");
+
+    static constexpr std::array<WireFieldInfo, sizeof...(Fields)> fields{WireFieldInfo{Fields::name, Fields::offset, Fields::size, Fields::endian}...};
+
+    static constexpr quint32 size()
+    {
+        quint32 end = 0;
+        for (const auto &field : fields)
+            end = std::max(end, field.offset + field.size);
+
+        return end;
+    }
+
+    // Fields are declared in wire order and cover [0, size()) without gaps or overlaps.
+    static constexpr bool isContiguous()
+    {
+        quint32 expected = 0;
+        for (const auto &field : fields)
+        {
+            if (field.offset != expected)
+                return false;
+
+            expected += field.size;
+        }
+
+        return expected == size();
+    }
+
+    // Number of fields declared for Member; a layout lists each member at most once.
+    template <auto Member> static constexpr size_t countOf()
+    {
+        return (matches<Member, Fields>() + ...);
+    }
+
+    template <auto Member> static constexpr quint32 offsetOf()
+    {
+        static_assert(countOf<Member>() == 1, "Member is not a field of this layout");
+
+        quint32 result = 0;
+        ((matches<Member, Fields>() ? (result = Fields::offset, true) : false), ...);
+        return result;
+    }
+
+    template <auto Member> static constexpr WireEndian endianOf()
+    {
+        static_assert(countOf<Member>() == 1, "Member is not a field of this layout");
+
+        WireEndian result = WireEndian::Little;
+        ((matches<Member, Fields>() ? (result = Fields::endian, true) : false), ...);
+        return result;
+    }
+
+    // Decodes the scalar field Member alone; the caller guarantees size() readable bytes.
+    template <auto Member> static auto load(const uchar *data)
+    {
+        using Value = typename wire_detail::MemberTraits<decltype(Member)>::Value;
+        static_assert(wire_detail::ScalarOf<Value>::count == 1, "Only scalar fields can be loaded alone");
+
+        return wire_detail::load<Value, endianOf<Member>()>(data + offsetOf<Member>());
+    }
+
+    // Branch-free decode of all fields; the caller guarantees size() readable bytes.
+    template <typename Owner> static void decode(const uchar *data, Owner &packet)
+    {
+        (Fields::decode(data, packet), ...);
+    }
+
+    // Sequential decode for QDataStream-like inputs, in wire order.
+    template <typename Stream, typename Owner> static Stream &read(Stream &in, Owner &packet)
+    {
+        (Fields::read(in, packet), ...);
+        return in;
+    }
+
+  private:
+    template <auto Member, typename Field> static constexpr bool matches()
+    {
+        if constexpr (std::is_same_v<decltype(Member), std::remove_cv_t<decltype(Field::member)>>)
+            return Member == Field::member;
+        else
+            return false;
+    }
+};
+
+} // namespace network
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace network
+{
+
+enum class EventError
+{
+    NotEnoughBytes,
+    InvalidDeviceId,
+    UnsupportedPacketType,
+    ChecksumMismatch,
+    ParseError,
+    RtcMismatch
+};
+
+} // namespace network
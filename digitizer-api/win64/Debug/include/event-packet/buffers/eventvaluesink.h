@@ -0,0 +1,174 @@
+#pragma once
+
+#include "networkpacket.h"
+#include "packetbuffer.h"
+#include "payloadpool.h"
+#include "receivepipeline.h"
+#include "packetwrappers/eventvalue.h"
+
+#include <QObject>
+
+#include <any>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Callback delivery of EventRecords, the value-type data path.
+ *
+ * A sink takes the packets a PacketBuffer parsed (its packetParsed()
+ * signal), the batches of a ReceivePipeline, or deliver() from the owner
+ * of either, and turns each batch into EventRecords without creating any
+ * QObject: PSD and PHA values are copied field by field, waveform and
+ * spectrum samples go into the device's PayloadPool. A waveform recorded
+ * with the info event right before it (same device and rtc) joins that
+ * event's record; any other waveform is a record of its own.
+ *
+ * Callbacks run on the thread that delivers, once per record and/or once
+ * per batch; the batch span is only valid during the call, and callbacks
+ * must not call back into the sink. attach(PacketBuffer *) connects
+ * through a context object owned by the sink, so destroying the sink
+ * disconnects it; a buffer that is parsing on another thread must be
+ * disconnected (or stopped), and an attached pipeline stopped, before the
+ * sink goes away.
+ */
+
+class EventValueSink final
+{
+  public:
+    using EventCallback = std::function<void(const EventRecord &)>;
+    using BatchCallback = std::function<void(std::span<const EventRecord>)>;
+
+    void setEventCallback(EventCallback callback)
+    {
+        std::lock_guard lock(m_mutex);
+        m_eventCallback = std::move(callback);
+    }
+
+    void setBatchCallback(BatchCallback callback)
+    {
+        std::lock_guard lock(m_mutex);
+        m_batchCallback = std::move(callback);
+    }
+
+    // The connection dies with the sink; disconnect it first to stop a buffer that keeps running.
+    QMetaObject::Connection attach(PacketBuffer *buffer)
+    {
+        return QObject::connect(buffer, &PacketBuffer::packetParsed, m_context.get(), [this](const std::vector<std::any> &packets) { deliver(packets); },
+                                Qt::DirectConnection);
+    }
+
+    /*
+     * Takes over the pipeline's batch callback; set before the pipeline
+     * starts. Waveforms only join an info event of the same batch, so add the
+     * info and waveform types with addParserPair(): with separate parsers a
+     * batch can end between an event and its waveform.
+     */
+    void attach(ReceivePipeline &pipeline)
+    {
+        pipeline.setBatchCallback([this](const NetworkPacketBatch &packets) { deliver(packets); });
+    }
+
+    void deliver(const std::vector<std::any> &packets)
+    {
+        deliverAll(packets);
+    }
+
+    void deliver(const NetworkPacketBatch &packets)
+    {
+        deliverAll(packets);
+    }
+
+  private:
+    template <typename Packets> void deliverAll(const Packets &packets)
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_eventCallback && !m_batchCallback)
+            return;
+
+        m_records.clear();
+        for (const auto &packet : packets)
+        {
+            auto value = toEventValue(packet, poolFor(packet));
+            if (!value)
+                continue;
+
+            if (auto *waveform = std::get_if<WaveformEvent>(&*value); waveform && !m_records.empty())
+            {
+                auto &previous = m_records.back();
+                const auto &info = headerOf(previous.info);
+                if (!previous.waveform && !std::holds_alternative<WaveformEvent>(previous.info) && info.deviceId == waveform->header.deviceId &&
+                    info.rtc == waveform->header.rtc)
+                {
+                    previous.waveform = std::move(*waveform);
+                    continue;
+                }
+            }
+
+            m_records.push_back({std::move(*value), std::nullopt});
+        }
+
+        if (m_eventCallback)
+        {
+            for (const auto &record : m_records)
+                m_eventCallback(record);
+        }
+
+        if (m_batchCallback && !m_records.empty())
+            m_batchCallback(m_records);
+
+        m_records.clear();
+    }
+
+    // The device's pool for packets with samples, nullptr for the others.
+    PayloadPool *poolFor(const std::any &packet)
+    {
+        if (const auto *waveform = std::any_cast<WaveformNetworkPacket>(&packet))
+            return poolOf(waveform->deviceId);
+        if (const auto *spectrum16 = std::any_cast<DeviceSpectrum16>(&packet))
+            return poolOf(spectrum16->deviceId);
+        if (const auto *spectrum32 = std::any_cast<DeviceSpectrum32>(&packet))
+            return poolOf(spectrum32->deviceId);
+
+        return nullptr;
+    }
+
+    PayloadPool *poolFor(const NetworkPacket &packet)
+    {
+        return std::visit(
+            [this](const auto &parsed) -> PayloadPool * {
+                using Packet = std::decay_t<decltype(parsed)>;
+                if constexpr (std::is_same_v<Packet, WaveformNetworkPacket> || std::is_same_v<Packet, DeviceSpectrum16> ||
+                              std::is_same_v<Packet, DeviceSpectrum32>)
+                    return poolOf(parsed.deviceId);
+                else
+                    return nullptr;
+            },
+            packet);
+    }
+
+    PayloadPool *poolOf(quint32 deviceId)
+    {
+        auto &pool = m_pools[deviceId];
+        if (!pool)
+            pool = PayloadPools::instance().attach(deviceId);
+
+        return pool.get();
+    }
+
+    std::unique_ptr<QObject> m_context = std::make_unique<QObject>();
+
+    std::mutex m_mutex;
+    EventCallback m_eventCallback;
+    BatchCallback m_batchCallback;
+    std::vector<EventRecord> m_records;
+    std::map<quint32, std::shared_ptr<PayloadPool>> m_pools;
+};
+
+} // namespace network
@@ -0,0 +1,410 @@
+#pragma once
+
+#include "iouringingest.h"
+#include "pipelinelimits.h"
+#include "slabpool.h"
+#include "threadplacement.h"
+
+#include <QObject>
+#include <QString>
+#include <QTcpSocket>
+#include <QThread>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * I/O reactor threads for the device data sockets.
+ *
+ * A single thread reading every device socket saturates long before the
+ * parsers do once a few dozen digitizers stream waveforms. An
+ * IoReactorGroup runs N reactors, each a thread with its own event source;
+ * the connection handler assigns every accepted data socket to the reactor
+ * with the fewest devices, and from then on that reactor alone reads the
+ * socket into the device's SlabPool and hands the chunks to the device's
+ * framing stage on the reactor thread. Sockets never share a reactor's
+ * state with another reactor, so throughput scales with the reactor count
+ * until the framing or parser stages saturate.
+ *
+ * A reactor is an IoUringIngest where io_uring is available and the policy
+ * prefers it, otherwise a QThread whose event loop owns QTcpSockets. Both
+ * take ownership of the socket descriptor and honour the pool's SocketRead
+ * budget. Reactor threads are placed as I/O threads under a ThreadPlacement
+ * policy.
+ */
+
+enum class IoReactorBackend
+{
+    QtSocket,
+    IoUring
+};
+
+struct IoReactorPolicy
+{
+    int reactorCount{0}; // 0: a quarter of the hardware threads, at least one
+    bool preferIoUring{true};
+};
+
+struct IoReactorStats
+{
+    int index{};
+    IoReactorBackend backend{IoReactorBackend::QtSocket};
+    quint64 devices{};
+    quint64 bytes{};
+    quint64 wakeups{}; // readyRead dispatches, or io_uring_enter calls
+};
+
+class IoReactor
+{
+  public:
+    using ChunkHandler = std::function<void(SlabPool::Chunk &&)>;
+    using CloseHandler = std::function<void(int error)>;
+
+    virtual ~IoReactor() = default;
+
+    // Takes ownership of descriptor; chunks and the close notification are delivered on the reactor thread.
+    virtual bool adopt(quint32 deviceId, qintptr descriptor, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed) = 0;
+    // Closes the socket of deviceId without its close callback; returns once the reactor no longer reads into its pool.
+    virtual void detach(quint32 deviceId) = 0;
+    virtual IoReactorStats stats() const = 0;
+};
+
+class IoUringReactor final : public IoReactor
+{
+  public:
+    IoUringReactor(int index, std::unique_ptr<IoUringIngest> ingest) : m_index(index), m_ingest(std::move(ingest))
+    {
+    }
+
+    bool adopt(quint32 deviceId, qintptr descriptor, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed) override
+    {
+        if (pool)
+        {
+            std::lock_guard lock(m_mutex);
+            m_pools[deviceId] = pool;
+        }
+
+        return m_ingest->adopt(static_cast<int>(descriptor), std::move(pool), std::move(onChunk), std::move(onClosed));
+    }
+
+    void detach(quint32 deviceId) override
+    {
+        std::shared_ptr<SlabPool> pool;
+        {
+            std::lock_guard lock(m_mutex);
+            const auto entry = m_pools.find(deviceId);
+            if (entry == m_pools.end())
+                return;
+
+            pool = entry->second.lock();
+            m_pools.erase(entry);
+        }
+
+        if (pool)
+            m_ingest->detach(pool);
+    }
+
+    IoReactorStats stats() const override
+    {
+        const auto ingest = m_ingest->stats();
+        return {m_index, IoReactorBackend::IoUring, ingest.connections, ingest.bytes, ingest.enterCalls};
+    }
+
+  private:
+    const int m_index;
+    std::unique_ptr<IoUringIngest> m_ingest;
+
+    std::mutex m_mutex;
+    std::map<quint32, std::weak_ptr<SlabPool>> m_pools; // the ingest knows connections by pool
+};
+
+class QtSocketReactor final : public IoReactor
+{
+  public:
+    explicit QtSocketReactor(int index) : m_index(index), m_thread(std::make_unique<QThread>()), m_context(std::make_unique<QObject>())
+    {
+        m_thread->setObjectName(QString("IoReactor%1").arg(index));
+        m_context->moveToThread(m_thread.get());
+        QObject::connect(m_thread.get(), &QThread::started, m_context.get(), [] { ThreadPlacement::instance().pinCurrentThread(ThreadRole::Io); });
+        m_thread->start();
+    }
+
+    ~QtSocketReactor() override
+    {
+        m_thread->quit();
+        m_thread->wait();
+
+        // Sockets still open are closed without a callback.
+        for (auto &[deviceId, device] : m_devices)
+        {
+            QObject::disconnect(device.socket, nullptr, m_context.get(), nullptr);
+            device.pool->clearResumeHandler(device.resumeToken);
+        }
+
+        m_context.reset();
+    }
+
+    bool adopt(quint32 deviceId, qintptr descriptor, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed) override
+    {
+        if (!pool || !onChunk)
+            return false;
+
+        return QMetaObject::invokeMethod(
+            m_context.get(),
+            [this, deviceId, descriptor, pool = std::move(pool), onChunk = std::move(onChunk), onClosed = std::move(onClosed)]() mutable {
+                attach(deviceId, descriptor, std::move(pool), std::move(onChunk), std::move(onClosed));
+            },
+            Qt::QueuedConnection);
+    }
+
+    void detach(quint32 deviceId) override
+    {
+        if (QThread::currentThread() == m_thread.get())
+            drop(deviceId);
+        else
+            QMetaObject::invokeMethod(m_context.get(), [this, deviceId] { drop(deviceId); }, Qt::BlockingQueuedConnection);
+    }
+
+    IoReactorStats stats() const override
+    {
+        return {m_index, IoReactorBackend::QtSocket, m_deviceCount.load(std::memory_order_relaxed), m_bytes.load(std::memory_order_relaxed),
+                m_wakeups.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    struct Device
+    {
+        QTcpSocket *socket{};
+        std::shared_ptr<SlabPool> pool;
+        ChunkHandler onChunk;
+        quint64 resumeToken{};
+    };
+
+    // Runs on the reactor thread.
+    void attach(quint32 deviceId, qintptr descriptor, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed)
+    {
+        auto *socket = new QTcpSocket(m_context.get());
+        if (!socket->setSocketDescriptor(descriptor))
+        {
+            delete socket;
+            if (onClosed)
+                onClosed(-1);
+            return;
+        }
+
+        PipelineLimits::instance().applyTo(socket);
+
+        // A paused pool resumes on the releasing thread; the read itself is queued back to the reactor.
+        const auto resumeToken =
+            pool->setResumeHandler([this, deviceId] { QMetaObject::invokeMethod(m_context.get(), [this, deviceId] { read(deviceId); }, Qt::QueuedConnection); });
+
+        // A device that reconnects replaces its previous socket.
+        auto &device = m_devices[deviceId];
+        if (device.socket)
+        {
+            QObject::disconnect(device.socket, nullptr, m_context.get(), nullptr);
+            device.socket->deleteLater();
+        }
+        else
+        {
+            m_deviceCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        device = {socket, std::move(pool), std::move(onChunk), resumeToken};
+
+        QObject::connect(socket, &QTcpSocket::readyRead, m_context.get(), [this, deviceId] { read(deviceId); });
+        QObject::connect(socket, &QAbstractSocket::disconnected, m_context.get(), [this, deviceId, socket, onClosed = std::move(onClosed)] {
+            const auto entry = m_devices.find(deviceId);
+            if (entry == m_devices.end() || entry->second.socket != socket)
+                return;
+
+            read(deviceId);
+            entry->second.pool->clearResumeHandler(entry->second.resumeToken);
+            m_devices.erase(entry);
+            m_deviceCount.fetch_sub(1, std::memory_order_relaxed);
+            socket->deleteLater();
+
+            if (onClosed)
+                onClosed(0);
+        });
+
+        // Data that arrived before the connections were made has no readyRead of its own.
+        read(deviceId);
+    }
+
+    // Runs on the reactor thread; the socket is closed without a callback.
+    void drop(quint32 deviceId)
+    {
+        const auto entry = m_devices.find(deviceId);
+        if (entry == m_devices.end())
+            return;
+
+        auto &device = entry->second;
+        QObject::disconnect(device.socket, nullptr, m_context.get(), nullptr);
+        device.socket->abort();
+        device.socket->deleteLater();
+        device.pool->clearResumeHandler(device.resumeToken);
+
+        m_devices.erase(entry);
+        m_deviceCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void read(quint32 deviceId)
+    {
+        const auto device = m_devices.find(deviceId);
+        if (device == m_devices.end())
+            return;
+
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+        const auto bytes = device->second.pool->readFrom(device->second.socket, device->second.onChunk);
+        m_bytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    }
+
+    const int m_index;
+    std::unique_ptr<QThread> m_thread;
+    std::unique_ptr<QObject> m_context;
+    std::map<quint32, Device> m_devices; // reactor thread only
+
+    std::atomic<quint64> m_deviceCount{};
+    std::atomic<quint64> m_bytes{};
+    std::atomic<quint64> m_wakeups{};
+};
+
+class IoReactorGroup final
+{
+  public:
+    using ChunkHandler = IoReactor::ChunkHandler;
+    using CloseHandler = IoReactor::CloseHandler;
+
+    explicit IoReactorGroup(const IoReactorPolicy &policy = {})
+    {
+        const int count = policy.reactorCount > 0 ? policy.reactorCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency() / 4));
+
+        m_reactors.reserve(count);
+        m_load.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            std::unique_ptr<IoUringIngest> ingest = policy.preferIoUring ? IoUringIngest::create() : nullptr;
+            if (ingest)
+                m_reactors.push_back(std::make_unique<IoUringReactor>(i, std::move(ingest)));
+            else
+                m_reactors.push_back(std::make_unique<QtSocketReactor>(i));
+        }
+    }
+
+    IoReactorGroup(const IoReactorGroup &) = delete;
+    IoReactorGroup &operator=(const IoReactorGroup &) = delete;
+
+    int reactorCount() const
+    {
+        return static_cast<int>(m_reactors.size());
+    }
+
+    /*
+     * Hands the data socket of deviceId to the reactor with the fewest
+     * devices and returns its index, or -1 if the reactor refused it. A
+     * device that reconnects is assigned afresh; the reactor that had it
+     * closes the previous socket first, without its close callback, so the
+     * pool keeps a single reader. That waits for the reactor, so call this
+     * from the connection handler rather than from a reactor's callbacks,
+     * and for any one device from one thread at a time.
+     */
+    int assign(quint32 deviceId, qintptr descriptor, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed = {})
+    {
+        Assignment assignment;
+        int previous = -1;
+        {
+            std::lock_guard lock(m_mutex);
+
+            if (const auto current = m_assignments.find(deviceId); current != m_assignments.end())
+                previous = current->second.reactor;
+
+            release(deviceId);
+            assignment = {static_cast<int>(std::min_element(m_load.begin(), m_load.end()) - m_load.begin()), ++m_generation};
+            ++m_load[assignment.reactor];
+            m_assignments[deviceId] = assignment;
+        }
+
+        if (previous >= 0)
+            m_reactors[previous]->detach(deviceId);
+
+        // A close that arrives after the device was assigned again leaves the new assignment alone.
+        auto closed = [this, deviceId, assignment, onClosed = std::move(onClosed)](int error) {
+            releaseIfCurrent(deviceId, assignment);
+            if (onClosed)
+                onClosed(error);
+        };
+
+        if (!m_reactors[assignment.reactor]->adopt(deviceId, descriptor, std::move(pool), std::move(onChunk), std::move(closed)))
+        {
+            releaseIfCurrent(deviceId, assignment);
+            return -1;
+        }
+
+        return assignment.reactor;
+    }
+
+    // Reactor serving deviceId, -1 if none.
+    int reactorOf(quint32 deviceId) const
+    {
+        std::lock_guard lock(m_mutex);
+        const auto assignment = m_assignments.find(deviceId);
+        return assignment != m_assignments.end() ? assignment->second.reactor : -1;
+    }
+
+    std::vector<IoReactorStats> snapshot() const
+    {
+        std::vector<IoReactorStats> result;
+        result.reserve(m_reactors.size());
+        for (const auto &reactor : m_reactors)
+            result.push_back(reactor->stats());
+
+        return result;
+    }
+
+  private:
+    struct Assignment
+    {
+        int reactor{-1};
+        quint64 generation{};
+    };
+
+    void release(quint32 deviceId)
+    {
+        const auto assignment = m_assignments.find(deviceId);
+        if (assignment == m_assignments.end())
+            return;
+
+        --m_load[assignment->second.reactor];
+        m_assignments.erase(assignment);
+    }
+
+    void releaseIfCurrent(quint32 deviceId, const Assignment &expected)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto assignment = m_assignments.find(deviceId);
+        if (assignment != m_assignments.end() && assignment->second.generation == expected.generation)
+            release(deviceId);
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<int> m_load;
+    std::map<quint32, Assignment> m_assignments;
+    quint64 m_generation{};
+
+    // Declared last so the reactors, whose close callbacks use the members above, stop first.
+    std::vector<std::unique_ptr<IoReactor>> m_reactors;
+};
+
+} // namespace network
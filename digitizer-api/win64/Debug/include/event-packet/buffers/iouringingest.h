@@ -0,0 +1,703 @@
+#pragma once
+
+#include "slabpool.h"
+#include "threadplacement.h"
+
+#include <QByteArrayView>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>) && __has_include(<sys/eventfd.h>)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define NETWORK_HAS_IO_URING 1
+#endif
+#endif
+
+namespace network
+{
+
+/*
+ * Optional Linux ingest backend for the device data sockets.
+ *
+ * One IoUringIngest owns an io_uring and a thread that serves any number of
+ * connected TCP sockets. Every socket has one multishot receive armed; the
+ * kernel picks a buffer from a ring of provided buffers registered with the
+ * io_uring, so a single io_uring_enter() both submits and reaps the data of
+ * many sockets, and a busy thread stays inside the kernel only while it has
+ * nothing to do. Each completion is copied into the socket's SlabPool and
+ * handed to onChunk on the ingest thread, straight into the device's
+ * framing stage; the buffer goes back to the ring right away.
+ *
+ * The SocketRead budget of the pool applies as for readFrom(): a
+ * completion that does not fit is held, with its buffer, until the pool
+ * resumes; once every buffer is held the receives stop and TCP flow
+ * control throttles the devices.
+ *
+ * adopt() takes ownership of the descriptor, e.g. from an overridden
+ * QTcpServer::incomingConnection(). onClosed is called on the ingest thread
+ * with 0 at end of stream or the errno of a failed receive, after which the
+ * descriptor is closed; descriptors still open at destruction are closed
+ * without a callback. A pool has a single reader, so adopting another
+ * socket for a pool closes the one it had, and detach() closes it without
+ * a replacement; neither calls onClosed.
+ *
+ * create() returns nullptr where io_uring or multishot receive is not
+ * available (other platforms, kernels before 6.0, seccomp filters); callers
+ * then keep the QTcpSocket path.
+ */
+
+struct IoUringIngestOptions
+{
+    unsigned entries{256};          // submission queue size
+    unsigned bufferCount{256};      // provided buffers, a power of two
+    unsigned bufferSize{64 * 1024}; // bytes per provided buffer
+};
+
+struct IoUringIngestStats
+{
+    quint64 connections{};
+    quint64 enterCalls{};
+    quint64 completions{};
+    quint64 bytes{};
+    quint64 rearms{};
+    quint64 bufferShortages{}; // receives stopped because every buffer was in use
+    quint64 heldCompletions{}; // completions held back by a paused pool
+};
+
+#ifdef NETWORK_HAS_IO_URING
+
+class IoUringIngest final
+{
+    struct Private
+    {
+    };
+
+  public:
+    using ChunkHandler = std::function<void(SlabPool::Chunk &&)>;
+    using CloseHandler = std::function<void(int error)>;
+
+    static std::unique_ptr<IoUringIngest> create(const IoUringIngestOptions &options = {})
+    {
+        auto ingest = std::make_unique<IoUringIngest>(Private{}, options);
+        if (!ingest->start())
+            return nullptr;
+
+        return ingest;
+    }
+
+    IoUringIngest(Private, const IoUringIngestOptions &options)
+        : m_bufferCount(std::bit_ceil(std::clamp(options.bufferCount, 1u, 32768u))), m_bufferSize(std::max(options.bufferSize, 1u)),
+          m_entries(std::max(options.entries, 8u))
+    {
+    }
+
+    IoUringIngest(const IoUringIngest &) = delete;
+    IoUringIngest &operator=(const IoUringIngest &) = delete;
+
+    ~IoUringIngest()
+    {
+        if (m_thread.joinable())
+        {
+            m_stopping.store(true);
+            m_wake->signal();
+            m_thread.join();
+        }
+
+        // Closing the ring cancels the armed receives before their buffers go away.
+        if (m_ringFd >= 0)
+            ::close(m_ringFd);
+
+        for (auto &connection : m_connections)
+        {
+            if (connection.fd >= 0)
+                ::close(connection.fd);
+
+            if (connection.pool)
+                connection.pool->clearResumeHandler(connection.resumeToken);
+        }
+
+        for (auto &connection : m_adopted)
+        {
+            ::close(connection.fd);
+            connection.pool->clearResumeHandler(connection.resumeToken);
+        }
+
+        for (auto &request : m_detaching)
+            request.done.set_value();
+
+        if (m_buffers != MAP_FAILED)
+            ::munmap(m_buffers, static_cast<size_t>(m_bufferCount) * m_bufferSize);
+        if (m_bufferRing != MAP_FAILED)
+            ::munmap(m_bufferRing, m_bufferCount * sizeof(io_uring_buf));
+        if (m_sqes != MAP_FAILED)
+            ::munmap(m_sqes, m_sqeBytes);
+        if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+            ::munmap(m_cqRing, m_cqRingBytes);
+        if (m_sqRing != MAP_FAILED)
+            ::munmap(m_sqRing, m_sqRingBytes);
+    }
+
+    // Takes ownership of a connected socket; chunks are read into pool and passed to onChunk on the ingest thread.
+    bool adopt(int fd, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed = {})
+    {
+        if (fd < 0 || !pool || !onChunk)
+            return false;
+
+        const auto resumeToken = pool->setResumeHandler([wake = std::weak_ptr(m_wake)] {
+            if (const auto target = wake.lock())
+                target->signal();
+        });
+
+        {
+            std::lock_guard lock(m_adoptMutex);
+            m_adopted.push_back({fd, std::move(pool), std::move(onChunk), std::move(onClosed), {}, false, -1, resumeToken, 0});
+        }
+
+        m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+        m_wake->signal();
+        return true;
+    }
+
+    // Closes the socket that reads into pool, without calling its onClosed; returns once the descriptor is closed. Not for use in onChunk.
+    void detach(const std::shared_ptr<SlabPool> &pool)
+    {
+        if (!pool)
+            return;
+
+        std::future<void> detached;
+        {
+            std::lock_guard lock(m_adoptMutex);
+            std::erase_if(m_adopted, [this, &pool](Connection &connection) {
+                if (connection.pool != pool)
+                    return false;
+
+                ::close(connection.fd);
+                pool->clearResumeHandler(connection.resumeToken);
+                m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            });
+
+            if (std::this_thread::get_id() != m_thread.get_id())
+            {
+                auto &request = m_detaching.emplace_back(Detach{pool, {}});
+                detached = request.done.get_future();
+            }
+        }
+
+        if (!detached.valid())
+        {
+            dropConnections(pool.get());
+            return;
+        }
+
+        m_wake->signal();
+        detached.wait();
+    }
+
+    IoUringIngestStats stats() const
+    {
+        return {m_connectionCount.load(std::memory_order_relaxed), m_enterCalls.load(std::memory_order_relaxed),
+                m_completions.load(std::memory_order_relaxed),     m_bytes.load(std::memory_order_relaxed),
+                m_rearms.load(std::memory_order_relaxed),          m_bufferShortages.load(std::memory_order_relaxed),
+                m_heldCompletions.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    static constexpr __u64 wakeTag = ~__u64{0};
+    static constexpr __u16 bufferGroup = 0;
+
+    struct Held
+    {
+        __u16 bufferId;
+        int length;
+    };
+
+    // The wakeup eventfd; pools that resume after the ingest is gone find it expired.
+    struct WakeFd
+    {
+        int fd{-1};
+
+        ~WakeFd()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        void signal() const
+        {
+            const eventfd_t one = 1;
+            [[maybe_unused]] const auto written = ::write(fd, &one, sizeof(one));
+        }
+    };
+
+    struct Connection
+    {
+        int fd{-1};
+        std::shared_ptr<SlabPool> pool;
+        ChunkHandler onChunk;
+        CloseHandler onClosed;
+        std::deque<Held> held;
+        bool armed{};
+        int closeError{-1}; // >= 0 once the stream ended behind held completions
+        quint64 resumeToken{};
+        quint32 serial{}; // tells the slot's completions from those of an earlier connection in it
+    };
+
+    struct Detach
+    {
+        std::shared_ptr<SlabPool> pool;
+        std::promise<void> done;
+    };
+
+    bool start()
+    {
+        io_uring_params params{};
+        m_ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, m_entries, &params));
+        if (m_ringFd < 0)
+            return false;
+
+        m_sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(__u32);
+        m_cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+            m_sqRingBytes = m_cqRingBytes = std::max(m_sqRingBytes, m_cqRingBytes);
+
+        m_sqRing = ::mmap(nullptr, m_sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED)
+            return false;
+
+        m_cqRing = singleMap ? m_sqRing : ::mmap(nullptr, m_cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED)
+            return false;
+
+        m_sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = ::mmap(nullptr, m_sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (m_sqes == MAP_FAILED)
+            return false;
+
+        auto *sq = static_cast<char *>(m_sqRing);
+        m_sqHead = reinterpret_cast<__u32 *>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<__u32 *>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<__u32 *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<__u32 *>(sq + params.sq_off.array);
+        m_sqEntries = params.sq_entries;
+
+        auto *cq = static_cast<char *>(m_cqRing);
+        m_cqHead = reinterpret_cast<__u32 *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<__u32 *>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<__u32 *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        if (!registerBuffers())
+            return false;
+
+        m_wake->fd = ::eventfd(0, EFD_CLOEXEC);
+        if (m_wake->fd < 0)
+            return false;
+
+        m_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    // Registers the provided buffer ring and hands every buffer to the kernel.
+    bool registerBuffers()
+    {
+        m_bufferRing = ::mmap(nullptr, m_bufferCount * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m_bufferRing == MAP_FAILED)
+            return false;
+
+        m_buffers = ::mmap(nullptr, static_cast<size_t>(m_bufferCount) * m_bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m_buffers == MAP_FAILED)
+            return false;
+
+        ThreadPlacement::instance().bindToNode(m_buffers, static_cast<size_t>(m_bufferCount) * m_bufferSize);
+
+        io_uring_buf_reg registration{};
+        registration.ring_addr = reinterpret_cast<__u64>(m_bufferRing);
+        registration.ring_entries = m_bufferCount;
+        registration.bgid = bufferGroup;
+        if (::syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+            return false;
+
+        for (unsigned id = 0; id < m_bufferCount; ++id)
+            provideBuffer(static_cast<__u16>(id));
+
+        return true;
+    }
+
+    void provideBuffer(__u16 id)
+    {
+        // The ring is an array of io_uring_buf whose first resv field is the tail; io_uring_buf_ring's flexible array member is laid out differently in C++.
+        auto *ring = static_cast<io_uring_buf *>(m_bufferRing);
+        auto &entry = ring[m_bufferTail & (m_bufferCount - 1)];
+        entry.addr = reinterpret_cast<__u64>(bufferData(id));
+        entry.len = m_bufferSize;
+        entry.bid = id;
+
+        std::atomic_ref(ring[0].resv).store(++m_bufferTail, std::memory_order_release);
+    }
+
+    char *bufferData(__u16 id) const
+    {
+        return static_cast<char *>(m_buffers) + static_cast<size_t>(id) * m_bufferSize;
+    }
+
+    io_uring_sqe &nextSqe()
+    {
+        while (m_sqLocalTail - std::atomic_ref(*m_sqHead).load(std::memory_order_acquire) >= m_sqEntries)
+            enter(0);
+
+        const auto index = m_sqLocalTail & m_sqMask;
+        auto &sqe = static_cast<io_uring_sqe *>(m_sqes)[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        m_sqArray[index] = index;
+        ++m_sqLocalTail;
+        ++m_toSubmit;
+
+        return sqe;
+    }
+
+    // Submits what is queued and, with waitFor > 0, waits for that many completions.
+    void enter(unsigned waitFor)
+    {
+        std::atomic_ref(*m_sqTail).store(m_sqLocalTail, std::memory_order_release);
+
+        const auto submitted = ::syscall(__NR_io_uring_enter, m_ringFd, m_toSubmit, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+        m_enterCalls.fetch_add(1, std::memory_order_relaxed);
+        if (submitted > 0)
+            m_toSubmit -= static_cast<unsigned>(submitted);
+    }
+
+    void armWake()
+    {
+        auto &sqe = nextSqe();
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = m_wake->fd;
+        sqe.addr = reinterpret_cast<__u64>(&m_wakeValue);
+        sqe.len = sizeof(m_wakeValue);
+        sqe.user_data = wakeTag;
+    }
+
+    void armReceive(size_t slot)
+    {
+        auto &sqe = nextSqe();
+        sqe.opcode = IORING_OP_RECV;
+        sqe.fd = m_connections[slot].fd;
+        sqe.ioprio = IORING_RECV_MULTISHOT;
+        sqe.flags = IOSQE_BUFFER_SELECT;
+        sqe.buf_group = bufferGroup;
+        sqe.user_data = (static_cast<__u64>(m_connections[slot].serial) << 32) | slot;
+
+        m_connections[slot].armed = true;
+        m_rearms.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run()
+    {
+        ThreadPlacement::instance().pinCurrentThread(ThreadRole::Io);
+
+        armWake();
+        while (!m_stopping.load())
+        {
+            takeAdopted();
+            retryHeld();
+
+            enter(1);
+            reap();
+        }
+    }
+
+    void takeAdopted()
+    {
+        std::vector<Connection> adopted;
+        std::vector<Detach> detaching;
+        {
+            std::lock_guard lock(m_adoptMutex);
+            adopted.swap(m_adopted);
+            detaching.swap(m_detaching);
+        }
+
+        for (auto &connection : adopted)
+        {
+            dropConnections(connection.pool.get());
+
+            size_t slot = 0;
+            while (slot < m_connections.size() && m_connections[slot].fd >= 0)
+                ++slot;
+
+            if (slot == m_connections.size())
+                m_connections.emplace_back();
+
+            connection.serial = ++m_serial;
+            m_connections[slot] = std::move(connection);
+            armReceive(slot);
+        }
+
+        for (auto &request : detaching)
+        {
+            dropConnections(request.pool.get());
+            request.done.set_value();
+        }
+    }
+
+    void reap()
+    {
+        auto head = *m_cqHead;
+        const auto tail = std::atomic_ref(*m_cqTail).load(std::memory_order_acquire);
+
+        for (; head != tail; ++head)
+        {
+            const auto cqe = m_cqes[head & m_cqMask];
+            m_completions.fetch_add(1, std::memory_order_relaxed);
+
+            if (cqe.user_data == wakeTag)
+                armWake();
+            else
+                complete(cqe);
+        }
+
+        std::atomic_ref(*m_cqHead).store(head, std::memory_order_release);
+    }
+
+    void complete(const io_uring_cqe &cqe)
+    {
+        const auto slot = static_cast<size_t>(cqe.user_data & 0xffffffffu);
+        auto &connection = m_connections[slot];
+
+        // What a dropped connection's receive still completes has nowhere to go; the buffer is returned at once.
+        if (connection.fd < 0 || connection.serial != static_cast<quint32>(cqe.user_data >> 32))
+        {
+            if (cqe.flags & IORING_CQE_F_BUFFER)
+                provideBuffer(static_cast<__u16>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+
+            return;
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+            connection.armed = false;
+
+        if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER))
+        {
+            m_bytes.fetch_add(static_cast<quint64>(cqe.res), std::memory_order_relaxed);
+            deliver(connection, {static_cast<__u16>(cqe.flags >> IORING_CQE_BUFFER_SHIFT), cqe.res});
+        }
+        else if (cqe.res == -ENOBUFS)
+        {
+            m_bufferShortages.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (cqe.res <= 0)
+        {
+            // Held data is still delivered before the connection reports its end.
+            if (connection.held.empty())
+                closeConnection(slot, -cqe.res);
+            else
+                connection.closeError = -cqe.res;
+
+            return;
+        }
+
+        // Rearmed when its held completions have gone through, so they keep their order.
+        if (!connection.armed && connection.held.empty() && freeBuffers() > 0)
+            armReceive(slot);
+    }
+
+    void deliver(Connection &connection, Held completion)
+    {
+        if (!connection.held.empty() || !store(connection, completion))
+        {
+            connection.held.push_back(completion);
+            m_heldBuffers++;
+            m_heldCompletions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Copies a completion into the connection's pool; false while the pool is paused.
+    bool store(Connection &connection, Held completion)
+    {
+        SlabPool::Chunk chunk;
+        const auto result = connection.pool->append(QByteArrayView(bufferData(completion.bufferId), completion.length), chunk);
+        if (result == SlabPool::AppendResult::Paused)
+            return false;
+
+        provideBuffer(completion.bufferId);
+        if (result == SlabPool::AppendResult::Stored)
+            connection.onChunk(std::move(chunk));
+
+        return true;
+    }
+
+    void retryHeld()
+    {
+        for (size_t slot = 0; slot < m_connections.size(); ++slot)
+        {
+            auto &connection = m_connections[slot];
+            if (connection.fd < 0)
+                continue;
+
+            while (!connection.held.empty() && store(connection, connection.held.front()))
+            {
+                connection.held.pop_front();
+                m_heldBuffers--;
+            }
+
+            if (connection.closeError >= 0)
+            {
+                if (connection.held.empty())
+                    closeConnection(slot, connection.closeError);
+
+                continue;
+            }
+
+            // A receive stopped for lack of buffers is restarted once some are back.
+            if (!connection.armed && connection.held.empty() && freeBuffers() > 0)
+                armReceive(slot);
+        }
+    }
+
+    void closeConnection(size_t slot, int error)
+    {
+        const auto connection = takeConnection(slot);
+        if (connection.onClosed)
+            connection.onClosed(error);
+    }
+
+    // Closes the connections that read into pool, without their onClosed.
+    void dropConnections(const SlabPool *pool)
+    {
+        for (size_t slot = 0; slot < m_connections.size(); ++slot)
+        {
+            if (m_connections[slot].fd >= 0 && m_connections[slot].pool.get() == pool)
+                takeConnection(slot);
+        }
+    }
+
+    Connection takeConnection(size_t slot)
+    {
+        auto connection = std::move(m_connections[slot]);
+        m_connections[slot] = {};
+
+        for (const auto &completion : connection.held)
+            provideBuffer(completion.bufferId);
+        m_heldBuffers -= connection.held.size();
+
+        // Closing the descriptor does not end a receive the ring still holds; the shutdown does.
+        if (connection.armed)
+            ::shutdown(connection.fd, SHUT_RDWR);
+
+        ::close(connection.fd);
+        connection.pool->clearResumeHandler(connection.resumeToken);
+        m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+
+        return connection;
+    }
+
+    size_t freeBuffers() const
+    {
+        return m_bufferCount - m_heldBuffers;
+    }
+
+    const unsigned m_bufferCount;
+    const unsigned m_bufferSize;
+    const unsigned m_entries;
+
+    int m_ringFd{-1};
+    std::shared_ptr<WakeFd> m_wake = std::make_shared<WakeFd>();
+    eventfd_t m_wakeValue{};
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{false};
+
+    void *m_sqRing{MAP_FAILED};
+    void *m_cqRing{MAP_FAILED};
+    void *m_sqes{MAP_FAILED};
+    size_t m_sqRingBytes{};
+    size_t m_cqRingBytes{};
+    size_t m_sqeBytes{};
+
+    __u32 *m_sqHead{};
+    __u32 *m_sqTail{};
+    __u32 *m_sqArray{};
+    __u32 m_sqMask{};
+    __u32 m_sqEntries{};
+    __u32 m_sqLocalTail{};
+    unsigned m_toSubmit{};
+
+    __u32 *m_cqHead{};
+    __u32 *m_cqTail{};
+    __u32 m_cqMask{};
+    io_uring_cqe *m_cqes{};
+
+    void *m_bufferRing{MAP_FAILED};
+    void *m_buffers{MAP_FAILED};
+    __u16 m_bufferTail{};
+    size_t m_heldBuffers{};
+
+    std::mutex m_adoptMutex;
+    std::vector<Connection> m_adopted;
+    std::vector<Detach> m_detaching;
+    std::vector<Connection> m_connections; // ingest thread only; a slot's index and serial make its user_data
+    quint32 m_serial{};
+
+    std::atomic<quint64> m_connectionCount{};
+    std::atomic<quint64> m_enterCalls{};
+    std::atomic<quint64> m_completions{};
+    std::atomic<quint64> m_bytes{};
+    std::atomic<quint64> m_rearms{};
+    std::atomic<quint64> m_bufferShortages{};
+    std::atomic<quint64> m_heldCompletions{};
+};
+
+#else
+
+class IoUringIngest final
+{
+  public:
+    using ChunkHandler = std::function<void(SlabPool::Chunk &&)>;
+    using CloseHandler = std::function<void(int error)>;
+
+    static std::unique_ptr<IoUringIngest> create(const IoUringIngestOptions &options = {})
+    {
+        Q_UNUSED(options)
+        return nullptr;
+    }
+
+    bool adopt(int fd, std::shared_ptr<SlabPool> pool, ChunkHandler onChunk, CloseHandler onClosed = {})
+    {
+        Q_UNUSED(fd)
+        Q_UNUSED(pool)
+        Q_UNUSED(onChunk)
+        Q_UNUSED(onClosed)
+        return false;
+    }
+
+    void detach(const std::shared_ptr<SlabPool> &pool)
+    {
+        Q_UNUSED(pool)
+    }
+
+    IoUringIngestStats stats() const
+    {
+        return {};
+    }
+};
+
+#endif
+
+} // namespace network
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QtEndian>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NETWORK_CHECKSUM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(NETWORK_CHECKSUM_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NETWORK_TARGET_SSE2 __attribute__((target("sse2")))
+#define NETWORK_TARGET_AVX2 __attribute__((target("avx2")))
+#define NETWORK_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define NETWORK_TARGET_SSE2
+#define NETWORK_TARGET_AVX2
+#define NETWORK_TARGET_AVX512
+#endif
+
+namespace network
+{
+
+/*
+ * Packet checksum: one's complement of the 16-bit little-endian word sum
+ * (modulo 2^16) over the packet body. A trailing odd byte is ignored.
+ *
+ * The word count is taken from the body size truncated to 16 bits, as the
+ * device firmware and the original implementation do: a body of 64 KiB or
+ * more only sums its first (size mod 65536) / 2 words. Waveforms and
+ * spectra can exceed that, so the truncation is part of the wire contract
+ * and must not be "fixed" here.
+ *
+ * Lane-wise 16-bit additions wrap exactly like the scalar sum, so the vector
+ * kernels accumulate in epi16 lanes and fold the lanes once at the end.
+ * The widest kernel supported by the running CPU is selected on first use.
+ */
+
+namespace checksum_detail
+{
+
+using SumWordsFn = quint16 (*)(const uchar *data, qsizetype words);
+
+inline quint16 sumWordsScalar(const uchar *data, qsizetype words)
+{
+    quint16 sum = 0;
+    for (qsizetype i = 0; i < words; ++i)
+        sum += qFromLittleEndian<quint16>(data + i * 2);
+
+    return sum;
+}
+
+#if defined(NETWORK_CHECKSUM_X86)
+
+NETWORK_TARGET_SSE2 inline quint16 foldLanes(__m128i acc)
+{
+    acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 4));
+    acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 2));
+    return static_cast<quint16>(_mm_cvtsi128_si32(acc));
+}
+
+NETWORK_TARGET_SSE2 inline quint16 sumWordsSse2(const uchar *data, qsizetype words)
+{
+    constexpr qsizetype wordsPerVector = 8;
+
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    qsizetype i = 0;
+
+    for (; i + 2 * wordsPerVector <= words; i += 2 * wordsPerVector)
+    {
+        acc0 = _mm_add_epi16(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 2)));
+        acc1 = _mm_add_epi16(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + (i + wordsPerVector) * 2)));
+    }
+
+    for (; i + wordsPerVector <= words; i += wordsPerVector)
+        acc0 = _mm_add_epi16(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 2)));
+
+    return static_cast<quint16>(foldLanes(_mm_add_epi16(acc0, acc1)) + sumWordsScalar(data + i * 2, words - i));
+}
+
+NETWORK_TARGET_AVX2 inline quint16 sumWordsAvx2(const uchar *data, qsizetype words)
+{
+    constexpr qsizetype wordsPerVector = 16;
+
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    qsizetype i = 0;
+
+    for (; i + 2 * wordsPerVector <= words; i += 2 * wordsPerVector)
+    {
+        acc0 = _mm256_add_epi16(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 2)));
+        acc1 = _mm256_add_epi16(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + (i + wordsPerVector) * 2)));
+    }
+
+    for (; i + wordsPerVector <= words; i += wordsPerVector)
+        acc0 = _mm256_add_epi16(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 2)));
+
+    const __m256i acc = _mm256_add_epi16(acc0, acc1);
+    __m128i half = _mm_add_epi16(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+
+    // At most 15 words remain; take 8 of them in one step so a 48-byte body does not end in a long scalar tail.
+    if (i + wordsPerVector / 2 <= words)
+    {
+        half = _mm_add_epi16(half, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 2)));
+        i += wordsPerVector / 2;
+    }
+
+    return static_cast<quint16>(foldLanes(half) + sumWordsScalar(data + i * 2, words - i));
+}
+
+NETWORK_TARGET_AVX512 inline quint16 sumWordsAvx512(const uchar *data, qsizetype words)
+{
+    constexpr qsizetype wordsPerVector = 32;
+
+    __m512i acc = _mm512_setzero_si512();
+    qsizetype i = 0;
+
+    for (; i + wordsPerVector <= words; i += wordsPerVector)
+        acc = _mm512_add_epi16(acc, _mm512_loadu_si512(data + i * 2));
+
+    // The remaining words go in one masked load; masked-off lanes read as zero and do not fault.
+    if (i < words)
+    {
+        const auto mask = static_cast<__mmask32>((1ull << (words - i)) - 1);
+        acc = _mm512_add_epi16(acc, _mm512_maskz_loadu_epi16(mask, data + i * 2));
+    }
+
+    // Zero-masked extracts: GCC's plain cast and extract start from an undefined register and trip -Wuninitialized.
+    const __m256i quarter = _mm256_add_epi16(_mm512_maskz_extracti64x4_epi64(0xFF, acc, 0), _mm512_maskz_extracti64x4_epi64(0xFF, acc, 1));
+    const __m128i half = _mm_add_epi16(_mm256_castsi256_si128(quarter), _mm256_extracti128_si256(quarter, 1));
+
+    return foldLanes(half);
+}
+
+inline SumWordsFn resolveSumWords()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4]{};
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+
+    __cpuid(regs, 1);
+    const bool osXsave = (regs[2] & (1 << 27)) != 0;
+    const bool hasSse2 = (regs[3] & (1 << 26)) != 0;
+    const unsigned long long xcr0 = osXsave ? _xgetbv(0) : 0;
+    const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+    bool hasAvx2 = false;
+    bool hasAvx512 = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(regs, 7, 0);
+        hasAvx2 = ymmEnabled && (regs[1] & (1 << 5)) != 0;
+        hasAvx512 = zmmEnabled && (regs[1] & (1 << 16)) != 0 && (regs[1] & (1 << 30)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool hasSse2 = __builtin_cpu_supports("sse2");
+    const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    const bool hasAvx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+
+    if (hasAvx512)
+        return &sumWordsAvx512;
+    if (hasAvx2)
+        return &sumWordsAvx2;
+    if (hasSse2)
+        return &sumWordsSse2;
+
+    return &sumWordsScalar;
+}
+
+#else
+
+inline SumWordsFn resolveSumWords()
+{
+    return &sumWordsScalar;
+}
+
+#endif
+
+} // namespace checksum_detail
+
+inline quint16 calculateChecksum(QByteArrayView data)
+{
+    static const checksum_detail::SumWordsFn sumWords = checksum_detail::resolveSumWords();
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const qsizetype words = static_cast<quint16>(data.size()) / 2;
+    return static_cast<quint16>(~sumWords(bytes, words));
+}
+
+} // namespace network
@@ -1,17 +1,75 @@
 #pragma once
 
 #include "packetparser.h"
+#include "packets/detectron2dnetworkpacket.h"
+#include "packets/detectronstatisticnetworkpacket.h"
+#include "packets/devicespectrum16.h"
+#include "packets/devicespectrum32.h"
 #include "packets/eventpackettype.h"
+#include "packets/phanetworkpacket.h"
+#include "packets/psdnetworkpacket.h"
+#include "packets/psdnetworkpacketv2.h"
+#include "packets/waveformnetworkpacket.h"
 
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QDebug>
+#include <QtEndian>
 
 #include <expected>
 #include <limits>
+#include <optional>
+#include <type_traits>
 
 namespace network
 {
 
+/*
+ * Calls visitor(std::type_identity<T>{}) with the packet structure that
+ * carries the given EventPacketType on the wire, or returns std::nullopt for
+ * types without a structure.
+ */
+template <typename F>
+constexpr auto visitPacketStructure(EventPacketType type, F &&visitor) -> std::optional<std::invoke_result_t<F, std::type_identity<PsdNetworkPacket>>>
+{
+    switch (type)
+    {
+    case EventPacketType::InterleavedWaveform:
+    case EventPacketType::PsdWaveform:
+    case EventPacketType::PhaWaveform:
+    case EventPacketType::SplitUpWaveform:
+        return visitor(std::type_identity<WaveformNetworkPacket>{});
+    case EventPacketType::PsdEventInfo:
+        return visitor(std::type_identity<PsdNetworkPacket>{});
+    case EventPacketType::PhaEventInfo:
+        return visitor(std::type_identity<PhaNetworkPacket>{});
+    case EventPacketType::Detectron2DData:
+        return visitor(std::type_identity<Detectron2dNetworkPacket>{});
+    case EventPacketType::DetectronStatisticData:
+        return visitor(std::type_identity<DetectronStatisticNetworkPacket>{});
+    case EventPacketType::DeviceSpectrum16:
+        return visitor(std::type_identity<DeviceSpectrum16>{});
+    case EventPacketType::DeviceSpectrum32:
+        return visitor(std::type_identity<DeviceSpectrum32>{});
+    case EventPacketType::PsdEventInfoV2:
+        return visitor(std::type_identity<PsdNetworkPacketV2>{});
+    default:
+        return std::nullopt;
+    }
+}
+
+// Total wire size announced by a length-prefixed header; the caller guarantees fixedPartSize() readable bytes.
+template <typename T>
+    requires KnownSizeStructure<T>
+quint64 announcedPacketSize(const char *header)
+{
+    const auto arrayLength = qFromLittleEndian<quint32>(header + T::arrayLengthOffset());
+    const auto paddingLength = qFromLittleEndian<quint16>(header + T::paddingLengthOffset());
+
+    return static_cast<quint64>(T::fixedPartSize()) + static_cast<quint64>(arrayLength) * static_cast<quint64>(T::arrayItemSize()) +
+           static_cast<quint64>(paddingLength) * static_cast<quint64>(sizeof(qint16)) + static_cast<quint64>(sizeof(qint16));
+}
+
 template <typename T> std::expected<int, EventError> computePacketSizeFor(const QByteArray &buffer, int offset, EventPacketType type)
 {
     Q_UNUSED(type)
@@ -83,4 +141,58 @@ template <typename T> std::expected<int, EventError> computePacketSizeFor(const
     }
 }
 
+/*
+ * Size of the packet of structure T at offset, from a borrowed view and
+ * without logging: NotEnoughBytes while it may still complete, ParseError
+ * if it cannot be a T. computePacketSizeFor() above is the body the
+ * compiled libraries use and stays as it is.
+ */
+template <typename T> std::expected<int, EventError> framedPacketSize(QByteArrayView buffer, int offset)
+{
+    if constexpr (FixedSizeStructure<T>)
+    {
+        if (buffer.size() - offset < static_cast<int>(T::size()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        return static_cast<int>(T::size());
+    }
+    else if constexpr (KnownSizeStructure<T>)
+    {
+        if (buffer.size() - offset < static_cast<int>(T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        const auto totalSize64 = announcedPacketSize<T>(buffer.constData() + offset);
+
+        if (totalSize64 == 0 || totalSize64 > static_cast<quint64>(std::numeric_limits<int>::max()))
+            return std::unexpected(EventError::ParseError);
+
+        const int totalSize = static_cast<int>(totalSize64);
+
+        if (buffer.size() - offset < totalSize)
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        return totalSize;
+    }
+    else if constexpr (UnknownSizeStructure<T>)
+    {
+        if (buffer.size() - offset < static_cast<int>(T::fixedPartSize()))
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        static constexpr SignatureScanner scanner(T::signatureBytes);
+        const auto scan = scanner.scan(buffer.sliced(offset), T::fixedPartSize(), T::arrayPartSize(), T::arrayLimit());
+
+        if (scan.status == SignatureScanResult::Status::NeedMoreData)
+            return std::unexpected(EventError::NotEnoughBytes);
+
+        if (scan.status == SignatureScanResult::Status::NotFound)
+            return std::unexpected(EventError::ParseError);
+
+        return static_cast<int>(T::fixedPartSize() + scan.index * T::arrayPartSize() + T::signatureBytes.size() + sizeof(quint16));
+    }
+    else
+    {
+        return std::unexpected(EventError::ParseError);
+    }
+}
+
 } // namespace network
@@ -0,0 +1,389 @@
+#pragma once
+
+#include "progresssignal.h"
+
+#include <QAbstractSocket>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Memory limits of the receive pipeline.
+ *
+ * Each stage between the socket and the user callback gets a StageBudget per
+ * device: a byte and an element limit (0 for none) and what to do when an
+ * item does not fit. Block stalls the producer until a consumer releases
+ * part of the budget (see StageBudget::waitForRelease()). For SocketRead
+ * that stops reading the socket so that TCP flow control throttles the
+ * device; a later stage that blocks holds on to its input, which keeps the
+ * receive slabs charged and so carries the stall back to the socket. The
+ * drop policies discard the incoming item, the oldest queued one, or
+ * waveforms before anything else. They only apply to stages that hold
+ * whole packets or slices: SocketRead holds raw stream bytes, and dropping
+ * part of a TCP stream would cut packets apart, so it only takes Block.
+ * Every budget counts what it accepted, dropped and blocked, so a bounded
+ * pipeline never loses data silently.
+ *
+ * Limits are taken by budgets created afterwards; PipelineLimits::snapshot()
+ * reports the state of all live budgets.
+ */
+
+enum class PipelineStage
+{
+    SocketRead,    // receive slabs in flight (SlabPool); Block only
+    ParserQueue,   // slices queued for the parser workers (SliceWorker)
+    ParsedPending, // parsed packets waiting for delivery (ReceivePipeline)
+    Count
+};
+
+enum class OverflowPolicy
+{
+    Block,
+    DropNewest,
+    DropOldest,
+    DropWaveformsFirst
+};
+
+struct StageLimit
+{
+    qint64 maxBytes{};
+    qint64 maxElements{};
+    OverflowPolicy policy{OverflowPolicy::Block};
+};
+
+struct StageStats
+{
+    quint32 deviceId{};
+    PipelineStage stage{};
+    qint64 bytes{};
+    qint64 elements{};
+    qint64 highWaterBytes{};
+    quint64 accepted{};
+    quint64 dropped{};
+    quint64 droppedBytes{};
+    quint64 blocked{};
+};
+
+class StageBudget final
+{
+  public:
+    enum class Admission
+    {
+        Accept,
+        Block,      // wait for the consumer and try again
+        Drop,       // discard the incoming item
+        EvictOldest // discard the oldest queued item and try again
+    };
+
+    StageBudget(quint32 deviceId, PipelineStage stage, const StageLimit &limit) : m_deviceId(deviceId), m_stage(stage), m_limit(limit)
+    {
+    }
+
+    const StageLimit &limit() const
+    {
+        return m_limit;
+    }
+
+    /*
+     * Takes bytes and one element from the budget if they fit; otherwise says
+     * what the policy asks for. Concurrent producers reserve with
+     * compare-and-swap, so together they never exceed the limit; an empty
+     * stage takes any single item, so an oversized one cannot wedge it.
+     */
+    Admission admit(qint64 bytes, bool waveform = false)
+    {
+        if (reserve(bytes))
+        {
+            m_accepted.fetch_add(1, std::memory_order_relaxed);
+            return Admission::Accept;
+        }
+
+        switch (m_limit.policy)
+        {
+        case OverflowPolicy::Block:
+            return Admission::Block;
+        case OverflowPolicy::DropNewest:
+            return Admission::Drop;
+        case OverflowPolicy::DropOldest:
+            return Admission::EvictOldest;
+        case OverflowPolicy::DropWaveformsFirst:
+            return waveform ? Admission::Drop : Admission::EvictOldest;
+        }
+
+        return Admission::Block;
+    }
+
+    // Takes bytes and one element unconditionally, for stages that check isFull() before they grow.
+    void charge(qint64 bytes)
+    {
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_elements.fetch_add(1, std::memory_order_relaxed);
+        m_accepted.fetch_add(1, std::memory_order_relaxed);
+        updateHighWater(m_bytes.load(std::memory_order_relaxed));
+    }
+
+    // Returns an admitted item's share once it leaves the stage and wakes a producer blocked on the budget.
+    void release(qint64 bytes)
+    {
+        m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        m_elements.fetch_sub(1, std::memory_order_relaxed);
+        m_released.notify();
+    }
+
+    // Read before admit(); a Block answer then waits in waitForRelease() with it.
+    quint64 releaseEpoch() const
+    {
+        return m_released.epoch();
+    }
+
+    // Waits until something was released since seen or until deadline; returns whether something was.
+    bool waitForRelease(quint64 seen, ProgressSignal::Clock::time_point deadline)
+    {
+        return m_released.waitUntil(seen, deadline);
+    }
+
+    void countDrop(qint64 bytes)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_droppedBytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    }
+
+    void countBlock()
+    {
+        m_blocked.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool isFull() const
+    {
+        return !fits(0);
+    }
+
+    StageStats stats() const
+    {
+        return {m_deviceId,
+                m_stage,
+                m_bytes.load(std::memory_order_relaxed),
+                m_elements.load(std::memory_order_relaxed),
+                m_highWaterBytes.load(std::memory_order_relaxed),
+                m_accepted.load(std::memory_order_relaxed),
+                m_dropped.load(std::memory_order_relaxed),
+                m_droppedBytes.load(std::memory_order_relaxed),
+                m_blocked.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    void updateHighWater(qint64 total)
+    {
+        auto highWater = m_highWaterBytes.load(std::memory_order_relaxed);
+        while (total > highWater && !m_highWaterBytes.compare_exchange_weak(highWater, total, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    bool reserve(qint64 bytes)
+    {
+        auto usedBytes = m_bytes.load(std::memory_order_relaxed);
+        do
+        {
+            if (usedBytes != 0 && m_limit.maxBytes > 0 && usedBytes + bytes > m_limit.maxBytes)
+                return false;
+        } while (!m_bytes.compare_exchange_weak(usedBytes, usedBytes + bytes, std::memory_order_relaxed));
+
+        auto usedElements = m_elements.load(std::memory_order_relaxed);
+        do
+        {
+            if (usedElements != 0 && m_limit.maxElements > 0 && usedElements >= m_limit.maxElements)
+            {
+                // Hand the bytes back; a producer that saw them taken retries after the next release.
+                m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                m_released.notify();
+                return false;
+            }
+        } while (!m_elements.compare_exchange_weak(usedElements, usedElements + 1, std::memory_order_relaxed));
+
+        updateHighWater(usedBytes + bytes);
+        return true;
+    }
+
+    bool fits(qint64 bytes) const
+    {
+        const auto usedBytes = m_bytes.load(std::memory_order_relaxed);
+        const auto usedElements = m_elements.load(std::memory_order_relaxed);
+
+        // An empty stage takes any single item, so an oversized one cannot wedge it.
+        if (usedElements == 0)
+            return true;
+
+        if (m_limit.maxBytes > 0 && usedBytes + bytes > m_limit.maxBytes)
+            return false;
+
+        return m_limit.maxElements <= 0 || usedElements < m_limit.maxElements;
+    }
+
+    const quint32 m_deviceId;
+    const PipelineStage m_stage;
+    const StageLimit m_limit;
+
+    std::atomic<qint64> m_bytes{};
+    std::atomic<qint64> m_elements{};
+    std::atomic<qint64> m_highWaterBytes{};
+    std::atomic<quint64> m_accepted{};
+    std::atomic<quint64> m_dropped{};
+    std::atomic<quint64> m_droppedBytes{};
+    std::atomic<quint64> m_blocked{};
+
+    ProgressSignal m_released;
+};
+
+class PipelineLimits final
+{
+  public:
+    static PipelineLimits &instance()
+    {
+        static PipelineLimits limits;
+        return limits;
+    }
+
+    // Returns false, keeping the previous limit, for a drop policy on SocketRead.
+    bool setLimit(PipelineStage stage, const StageLimit &limit)
+    {
+        if (stage == PipelineStage::SocketRead && limit.policy != OverflowPolicy::Block)
+            return false;
+
+        std::lock_guard lock(m_mutex);
+        m_limits[static_cast<size_t>(stage)] = limit;
+        return true;
+    }
+
+    StageLimit limit(PipelineStage stage) const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_limits[static_cast<size_t>(stage)];
+    }
+
+    // The live budget of deviceId for stage, or a new one with the current limit.
+    std::shared_ptr<StageBudget> budget(quint32 deviceId, PipelineStage stage)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto &entry = m_budgets[{deviceId, stage}];
+        if (auto budget = entry.lock())
+            return budget;
+
+        auto budget = std::make_shared<StageBudget>(deviceId, stage, m_limits[static_cast<size_t>(stage)]);
+        entry = budget;
+        return budget;
+    }
+
+    std::vector<StageStats> snapshot()
+    {
+        std::lock_guard lock(m_mutex);
+
+        std::vector<StageStats> result;
+        for (auto it = m_budgets.begin(); it != m_budgets.end();)
+        {
+            if (const auto budget = it->second.lock())
+            {
+                result.push_back(budget->stats());
+                ++it;
+            }
+            else
+            {
+                it = m_budgets.erase(it);
+            }
+        }
+
+        return result;
+    }
+
+    /*
+     * Bounds Qt's own socket buffer to the SocketRead byte limit. Without it
+     * a stalled reader only moves the backlog into QAbstractSocket, and the
+     * device never sees a closed TCP window.
+     */
+    void applyTo(QAbstractSocket *socket) const
+    {
+        const auto socketLimit = limit(PipelineStage::SocketRead);
+        if (socket && socketLimit.policy == OverflowPolicy::Block && socketLimit.maxBytes > 0)
+            socket->setReadBufferSize(socketLimit.maxBytes);
+    }
+
+  private:
+    PipelineLimits()
+    {
+        m_limits[static_cast<size_t>(PipelineStage::SocketRead)] = {64 * 1024 * 1024, 0, OverflowPolicy::Block};
+        m_limits[static_cast<size_t>(PipelineStage::ParserQueue)] = {256 * 1024 * 1024, 0, OverflowPolicy::Block};
+        m_limits[static_cast<size_t>(PipelineStage::ParsedPending)] = {0, 1 << 20, OverflowPolicy::DropOldest};
+    }
+
+    mutable std::mutex m_mutex;
+    std::array<StageLimit, static_cast<size_t>(PipelineStage::Count)> m_limits{};
+    std::map<std::pair<quint32, PipelineStage>, std::weak_ptr<StageBudget>> m_budgets;
+};
+
+/*
+ * Appends item to a deque-backed stage (the parsed packets) under budget. sizeOf(item) gives its bytes and isWaveform(item) whether a
+ * DropWaveformsFirst stage may discard it before others. Block cannot wait
+ * in a single-threaded container, so it drops the incoming item like
+ * DropNewest; use it only for stages whose producer can stall. Returns
+ * whether item was stored. The consumer releases sizeOf(item) from the
+ * budget when it takes an item out.
+ */
+template <typename T, typename SizeOf, typename IsWaveform>
+bool pushBounded(std::deque<T> &queue, T &&item, StageBudget &budget, SizeOf &&sizeOf, IsWaveform &&isWaveform)
+{
+    const auto bytes = static_cast<qint64>(sizeOf(item));
+    const bool waveform = isWaveform(item);
+
+    for (;;)
+    {
+        switch (budget.admit(bytes, waveform))
+        {
+        case StageBudget::Admission::Accept:
+            queue.push_back(std::move(item));
+            return true;
+
+        case StageBudget::Admission::Block:
+            budget.countBlock();
+            [[fallthrough]];
+        case StageBudget::Admission::Drop:
+            budget.countDrop(bytes);
+            return false;
+
+        case StageBudget::Admission::EvictOldest: {
+            auto victim = queue.begin();
+            if (budget.limit().policy == OverflowPolicy::DropWaveformsFirst)
+            {
+                const auto waveformVictim = std::find_if(queue.begin(), queue.end(), isWaveform);
+                if (waveformVictim != queue.end())
+                    victim = waveformVictim;
+            }
+
+            if (victim == queue.end())
+            {
+                budget.countDrop(bytes);
+                return false;
+            }
+
+            const auto victimBytes = static_cast<qint64>(sizeOf(*victim));
+            budget.release(victimBytes);
+            budget.countDrop(victimBytes);
+            queue.erase(victim);
+            break;
+        }
+        }
+    }
+}
+
+} // namespace network
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "pipelinelimits.h"
+#include "threadplacement.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Per-device pool of preallocated, reference-counted receive slabs.
+ *
+ * Socket data is read straight into the writable tail of the current slab
+ * and handed on as a Chunk, a shared slab pointer plus offset and length.
+ * That matches the (buffer, offset, length) slices the parser workers
+ * consume, so no bytes are copied between the socket and the parsers.
+ * Consecutive chunks share one slab, so a chunk costs no heap allocation;
+ * once the pool has moved past a slab and the last chunk referencing it is
+ * released, the slab returns to the idle list and is reused.
+ *
+ * With a SocketRead budget every live slab is charged to it. readFrom()
+ * starts no new slab while the budget is full: it stops reading and calls
+ * the resume handler once a slab has been released (the socket's own buffer
+ * must be bounded too, see PipelineLimits::applyTo()). The budget always
+ * blocks; PipelineLimits refuses drop policies for SocketRead, since bytes
+ * discarded from the middle of the stream would cut packets apart.
+ *
+ * Under a ThreadPlacement policy new slabs are bound to the NIC's NUMA node
+ * before their pages are first written; pinning the reading thread is up to
+ * its owner.
+ *
+ * Only one thread reads into the pool. Chunks may be released on any thread.
+ */
+
+class SlabPool final : public std::enable_shared_from_this<SlabPool>
+{
+    struct Private
+    {
+    };
+
+  public:
+    struct Chunk
+    {
+        QSharedPointer<QByteArray> slab;
+        int offset{};
+        int length{};
+
+        QByteArrayView bytes() const
+        {
+            return QByteArrayView(slab->constData() + offset, length);
+        }
+    };
+
+    static std::shared_ptr<SlabPool> create(int slabSize = 4 * 1024 * 1024, int maxIdleSlabs = 8)
+    {
+        return std::make_shared<SlabPool>(Private{}, slabSize, maxIdleSlabs);
+    }
+
+    SlabPool(Private, int slabSize, int maxIdleSlabs) : m_slabSize(std::max(slabSize, 1)), m_maxIdleSlabs(std::max(maxIdleSlabs, 0))
+    {
+    }
+
+    SlabPool(const SlabPool &) = delete;
+    SlabPool(SlabPool &&) = delete;
+    SlabPool &operator=(const SlabPool &) = delete;
+    SlabPool &operator=(SlabPool &&) = delete;
+
+    ~SlabPool()
+    {
+        for (auto *slab : m_idle)
+            delete slab;
+    }
+
+    int slabSize() const
+    {
+        return m_slabSize;
+    }
+
+    // Set before the first read.
+    void setBudget(std::shared_ptr<StageBudget> budget)
+    {
+        m_budget = std::move(budget);
+    }
+
+    /*
+     * Called on the releasing thread when a paused reader may continue; it
+     * should schedule the next readFrom(). Returns a token for
+     * clearResumeHandler(), so that a reader the pool was taken from cannot
+     * clear the handler of the reader that replaced it.
+     */
+    quint64 setResumeHandler(std::function<void()> handler)
+    {
+        std::lock_guard lock(m_idleMutex);
+        m_resume = std::move(handler);
+        return ++m_resumeToken;
+    }
+
+    // Clears the resume handler if it is still the one token was returned for.
+    void clearResumeHandler(quint64 token)
+    {
+        std::lock_guard lock(m_idleMutex);
+        if (token == m_resumeToken)
+            m_resume = {};
+    }
+
+    bool isPaused() const
+    {
+        return m_paused.load();
+    }
+
+    quint64 slabsAllocated() const
+    {
+        return m_slabsAllocated.load(std::memory_order_relaxed);
+    }
+
+    quint64 slabsReused() const
+    {
+        return m_slabsReused.load(std::memory_order_relaxed);
+    }
+
+    // Writable tail of the current slab with room for at least minimumBytes; starts a new slab when needed.
+    std::span<char> writable(int minimumBytes = 1)
+    {
+        if (!m_current || m_current->size() - m_used < minimumBytes)
+            startSlab(minimumBytes);
+
+        return std::span<char>(m_current->data() + m_used, static_cast<size_t>(m_current->size() - m_used));
+    }
+
+    // Publishes the next `bytes` written into writable() as a chunk.
+    Chunk commit(int bytes)
+    {
+        Chunk chunk{m_current, m_used, bytes};
+        m_used += bytes;
+
+        return chunk;
+    }
+
+    /*
+     * Reads everything the device has buffered into slabs and passes each
+     * chunk to onChunk. Each read fills what is left of the current slab; a
+     * new slab is only started once it is full. Returns the number of bytes
+     * read.
+     */
+    template <typename Callback> qint64 readFrom(QIODevice *device, Callback &&onChunk)
+    {
+        qint64 total = 0;
+
+        for (auto available = device->bytesAvailable(); available > 0; available = device->bytesAvailable())
+        {
+            if (!admitRead(1))
+                return total;
+
+            const auto span = writable();
+            const auto bytesRead = device->read(span.data(), static_cast<qint64>(span.size()));
+            if (bytesRead <= 0)
+                break;
+
+            onChunk(commit(static_cast<int>(bytesRead)));
+            total += bytesRead;
+        }
+
+        return total;
+    }
+
+    enum class AppendResult
+    {
+        Stored,
+        Paused // nothing stored; the resume handler is called once a slab is released
+    };
+
+    /*
+     * Copies bytes into the pool as one chunk, for readers that receive into
+     * buffers of their own (IoUringIngest). The budget applies as in
+     * readFrom().
+     */
+    AppendResult append(QByteArrayView bytes, Chunk &chunk)
+    {
+        const auto size = static_cast<int>(bytes.size());
+        if (!admitRead(size))
+            return AppendResult::Paused;
+
+        const auto span = writable(size);
+        std::memcpy(span.data(), bytes.data(), static_cast<size_t>(size));
+        chunk = commit(size);
+        return AppendResult::Stored;
+    }
+
+  private:
+    bool needsSlab(int minimumBytes) const
+    {
+        return !m_current || m_current->size() - m_used < minimumBytes;
+    }
+
+    // Whether `wanted` bytes may be read now; a new slab needs room in the budget, otherwise the pool pauses.
+    bool admitRead(int wanted)
+    {
+        if (!needsSlab(wanted) || !m_budget || !m_budget->isFull())
+            return true;
+
+        m_budget->countBlock();
+        m_paused.store(true);
+
+        // A slab released since the check would have found the flag still clear.
+        return !m_budget->isFull() && m_paused.exchange(false);
+    }
+
+    void startSlab(int minimumBytes)
+    {
+        const auto size = std::max(m_slabSize, minimumBytes);
+
+        QByteArray *slab = nullptr;
+        if (size == m_slabSize)
+        {
+            std::lock_guard lock(m_idleMutex);
+            if (!m_idle.empty())
+            {
+                slab = m_idle.back();
+                m_idle.pop_back();
+            }
+        }
+
+        if (slab)
+        {
+            m_slabsReused.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            slab = new QByteArray(size, Qt::Uninitialized);
+            ThreadPlacement::instance().bindToNode(slab->data(), static_cast<size_t>(size));
+            m_slabsAllocated.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (m_budget)
+            m_budget->charge(size);
+
+        m_current = QSharedPointer<QByteArray>(slab, [pool = weak_from_this(), budget = m_budget, size](QByteArray *released) {
+            if (budget)
+                budget->release(size);
+
+            if (const auto owner = pool.lock())
+                owner->recycle(released);
+            else
+                delete released;
+        });
+        m_used = 0;
+    }
+
+    void recycle(QByteArray *slab)
+    {
+        std::function<void()> resume;
+        {
+            std::lock_guard lock(m_idleMutex);
+            if (m_paused.exchange(false))
+                resume = m_resume;
+
+            if (slab->size() == m_slabSize && static_cast<int>(m_idle.size()) < m_maxIdleSlabs)
+            {
+                m_idle.push_back(slab);
+                slab = nullptr;
+            }
+        }
+
+        delete slab;
+
+        if (resume)
+            resume();
+    }
+
+    const int m_slabSize;
+    const int m_maxIdleSlabs;
+
+    QSharedPointer<QByteArray> m_current;
+    int m_used{};
+
+    std::mutex m_idleMutex;
+    std::vector<QByteArray *> m_idle;
+
+    std::shared_ptr<StageBudget> m_budget;
+    std::function<void()> m_resume;
+    quint64 m_resumeToken{};
+    std::atomic<bool> m_paused{false};
+
+    std::atomic<quint64> m_slabsAllocated{};
+    std::atomic<quint64> m_slabsReused{};
+};
+
+} // namespace network
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "packetparser.h"
+#include "sliceparserworker.h"
+#include "packets/eventpackettype.h"
+
+#include <QPair>
+#include <QSharedPointer>
+#include <QVector>
+
+namespace network
+{
+
+// Executor-driven counterpart of ParserPairWorker; see SliceParserWorker.
+template <NetworkPacketAlternative InfoT, NetworkPacketAlternative WaveT> class SlicePairWorker final : public SliceWorker
+{
+  public:
+    explicit SlicePairWorker(std::unique_ptr<PacketParser<InfoT>> infoParser, std::unique_ptr<PacketParser<WaveT>> waveParser)
+        : m_infoParser(std::move(infoParser)), m_waveParser(std::move(waveParser))
+    {
+    }
+
+    ~SlicePairWorker() override
+    {
+        shutdown();
+    }
+
+    void parseBytes(const QByteArray &bytes)
+    {
+        auto shared = QSharedPointer<QByteArray>::create(bytes);
+        const auto length = static_cast<int>(shared->size());
+        enqueueSingleJob(shared, 0, length, true);
+    }
+
+    void enqueueSlices(const QSharedPointer<QByteArray> &buffer, const QVector<QPair<int, int>> &slices)
+    {
+        if (!buffer || slices.isEmpty())
+            return;
+
+        if (slices.size() >= 2)
+        {
+            const auto &[o1, l1] = slices[0];
+            const auto &[o2, l2] = slices[1];
+            enqueuePairJob(buffer, o1, l1, o2, l2);
+        }
+        else
+        {
+            const auto &[offset, length] = slices.front();
+            enqueueSingleJob(buffer, offset, length, true);
+        }
+    }
+
+    Intake enqueuePairJob(const QSharedPointer<QByteArray> &buffer, int infoOffset, int infoLength, int waveOffset, int waveLength)
+    {
+        if (!isValidSlice(buffer, infoOffset, infoLength) || !isValidSlice(buffer, waveOffset, waveLength))
+        {
+            reject(EventError::ParseError, m_infoParser->packetType());
+            reject(EventError::ParseError, m_waveParser->packetType());
+            return Intake::Dropped;
+        }
+
+        return submit(SliceJob{buffer, infoOffset, infoLength, waveOffset, waveLength});
+    }
+
+    Intake enqueueSingleJob(const QSharedPointer<QByteArray> &buffer, int offset, int length, bool isInfo)
+    {
+        if (!isValidSlice(buffer, offset, length))
+        {
+            reject(EventError::ParseError, isInfo ? m_infoParser->packetType() : m_waveParser->packetType());
+            return Intake::Dropped;
+        }
+
+        if (isInfo)
+            return submit(SliceJob{buffer, offset, length, -1, -1});
+
+        return submit(SliceJob{buffer, -1, -1, offset, length});
+    }
+
+    EventPacketType infoType() const
+    {
+        return m_infoParser->packetType();
+    }
+
+    EventPacketType waveType() const
+    {
+        return m_waveParser->packetType();
+    }
+
+  protected:
+    void processJob(const SliceJob &job, ParsedSlice &slice) override
+    {
+        const bool hasInfo = job.offset >= 0 && job.length > 0;
+        const bool hasWave = job.pairOffset >= 0 && job.pairLength > 0;
+
+        if (hasInfo && hasWave)
+        {
+            const QByteArrayView infoView(job.buffer->constData() + job.offset, job.length);
+            const QByteArrayView waveView(job.buffer->constData() + job.pairOffset, job.pairLength);
+
+            const auto infoResult = m_infoParser->decodePacket(infoView);
+            if (!infoResult.has_value())
+            {
+                slice.failed(infoResult.error(), m_infoParser->packetType());
+                slice.failed(infoResult.error(), m_waveParser->packetType());
+                return;
+            }
+
+            const auto waveResult = m_waveParser->decodePacket(waveView);
+            if (!waveResult.has_value())
+            {
+                slice.failed(waveResult.error(), m_infoParser->packetType());
+                slice.failed(waveResult.error(), m_waveParser->packetType());
+                return;
+            }
+
+            auto &infoPacket = *infoResult;
+            auto &wavePacket = *waveResult;
+            if (infoPacket.rtc != wavePacket.rtc)
+            {
+                m_infoParser->recordError(EventError::RtcMismatch, infoView);
+                slice.failed(EventError::RtcMismatch, m_infoParser->packetType());
+                slice.failed(EventError::RtcMismatch, m_waveParser->packetType());
+                return;
+            }
+
+            slice.parsed(NetworkPacket(std::in_place_type<InfoT>, std::move(infoPacket)), m_infoParser->packetType());
+            slice.parsed(NetworkPacket(std::in_place_type<WaveT>, std::move(wavePacket)), m_waveParser->packetType());
+        }
+        else if (hasInfo)
+        {
+            const QByteArrayView view(job.buffer->constData() + job.offset, job.length);
+            auto result = m_infoParser->decodePacket(view);
+            if (!result.has_value())
+                slice.failed(result.error(), m_infoParser->packetType());
+            else
+                slice.parsed(NetworkPacket(std::in_place_type<InfoT>, std::move(*result)), m_infoParser->packetType());
+        }
+        else if (hasWave)
+        {
+            const QByteArrayView view(job.buffer->constData() + job.pairOffset, job.pairLength);
+            auto result = m_waveParser->decodePacket(view);
+            if (!result.has_value())
+                slice.failed(result.error(), m_waveParser->packetType());
+            else
+                slice.parsed(NetworkPacket(std::in_place_type<WaveT>, std::move(*result)), m_waveParser->packetType());
+        }
+    }
+
+    bool isWaveformJob(const SliceJob &job) const override
+    {
+        return job.pairOffset >= 0;
+    }
+
+  private:
+    std::unique_ptr<PacketParser<InfoT>> m_infoParser;
+    std::unique_ptr<PacketParser<WaveT>> m_waveParser;
+};
+
+} // namespace network
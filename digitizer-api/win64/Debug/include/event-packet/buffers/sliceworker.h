@@ -0,0 +1,470 @@
+#pragma once
+
+#include "parserexecutor.h"
+#include "pipelinelimits.h"
+#include "progresssignal.h"
+#include "reorderwindow.h"
+#include "spscqueue.h"
+
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace network
+{
+
+class ParserConcurrencyController;
+
+/*
+ * Slice descriptor handed to a parser worker. Single-packet jobs use offset
+ * and length; pair jobs put the waveform into pairOffset and pairLength.
+ * An unused half has offset -1. sequence is the job's number in the
+ * device's ReorderWindow, 0 while it has none.
+ */
+struct SliceJob
+{
+    QSharedPointer<QByteArray> buffer;
+    int offset{-1};
+    int length{};
+    int pairOffset{-1};
+    int pairLength{};
+    quint64 sequence{};
+};
+
+struct SliceWorkerStats
+{
+    quint64 jobs{};
+    quint64 batches{};
+    quint64 wakeups{};
+    quint64 busyNanos{};
+};
+
+/*
+ * Common job intake of the parser workers.
+ *
+ * Jobs are offered by one producer, the device's framing thread, and go
+ * into a lock-free SPSC ring. trySubmit() never waits: when the ring or the
+ * ParserQueue budget is full it answers Full and the producer calls
+ * waitForRoom(), which sleeps until a drain pops jobs or the budget is
+ * released. While the framing thread waits it reads no further input, so
+ * a Block budget stalls the stages in front of it down to the socket.
+ *
+ * Only the submit that finds the worker idle hands a drain task to the
+ * shared ParserExecutor, so a burst of N packets costs one task instead of
+ * N events, and a worker owns no thread. A drain processes at most drainQuantum jobs in batches and then
+ * requeues itself behind the other workers' drains. At most one drain per
+ * worker is queued or running, which keeps the ring single-consumer.
+ *
+ * processJob() collects the results of a job in a ParsedSlice. Without a
+ * reorder window they go to the result handler right away; with one,
+ * trySubmit() numbers the job and the drain deposits the batch's results in
+ * the window, whose handler receives them in sequence order. A worker is
+ * not a QObject and nothing is boxed in std::any on the way.
+ *
+ * Derived workers call shutdown() first thing in their destructor, so no
+ * drain can reach processJob() on a half-destroyed object.
+ */
+class SliceWorker
+{
+  public:
+    static constexpr size_t queueCapacity = 1024;
+    static constexpr size_t batchSize = 64;
+    static constexpr size_t drainQuantum = 4 * batchSize;
+
+    SliceWorker() : m_queue(queueCapacity)
+    {
+    }
+
+    virtual ~SliceWorker() = default;
+
+    SliceWorker(const SliceWorker &) = delete;
+    SliceWorker &operator=(const SliceWorker &) = delete;
+
+    // Receives the slices of jobs without a sequence number; set before the first job is submitted.
+    void setResultHandler(ParsedSliceHandler handler)
+    {
+        m_handler = std::move(handler);
+    }
+
+    enum class Intake
+    {
+        Queued,
+        Dropped, // discarded by the ParserQueue budget's drop policy
+        Full     // not taken; call waitForRoom() and offer the job again
+    };
+
+    /*
+     * Offers job without waiting. Full leaves job untouched and records what
+     * the worker is waiting for: room in the ring, a free number in the
+     * reorder window, or a release from the ParserQueue budget (under Block,
+     * or under an evicting policy while the consumers discard queued jobs,
+     * see evicts()).
+     */
+    Intake trySubmit(SliceJob &job)
+    {
+        const auto ringEpoch = m_consumed.epoch();
+        if (!m_queue.hasRoom())
+            return stall(Stall::Ring, ringEpoch);
+
+        if (m_window && job.sequence == 0)
+        {
+            const auto windowEpoch = m_window->spaceEpoch();
+            if (!m_window->hasSpace())
+                return stall(Stall::Window, windowEpoch);
+        }
+
+        if (m_budget)
+        {
+            const auto bytes = jobBytes(job);
+            const auto budgetEpoch = m_budget->releaseEpoch();
+            const auto admission = m_budget->admit(bytes, isWaveformJob(job));
+
+            if (admission == StageBudget::Admission::Drop)
+            {
+                m_budget->countDrop(bytes);
+                m_stall = Stall::None;
+                return Intake::Dropped;
+            }
+
+            if (admission != StageBudget::Admission::Accept)
+                return stall(Stall::Budget, budgetEpoch);
+        }
+
+        if (m_window && job.sequence == 0)
+            job.sequence = m_window->acquire();
+
+        m_queue.tryPush(std::move(job));
+        m_stall = Stall::None;
+        m_jobs.fetch_add(1, std::memory_order_relaxed);
+
+        wake();
+        return Intake::Queued;
+    }
+
+    // After Full: waits until the stalled resource may have room or until deadline; returns false on timeout.
+    bool waitForRoom(ProgressSignal::Clock::time_point deadline)
+    {
+        switch (m_stall)
+        {
+        case Stall::None:
+            return true;
+        case Stall::Ring:
+            return m_consumed.waitUntil(m_stallEpoch, deadline);
+        case Stall::Window:
+            return m_window->waitForSpace(m_stallEpoch, deadline);
+        case Stall::Budget:
+            return m_budget->waitForRelease(m_stallEpoch, deadline);
+        }
+
+        return true;
+    }
+
+    // Offers job until it is queued or dropped, blocking while the worker is full.
+    Intake submit(SliceJob &&job)
+    {
+        for (;;)
+        {
+            const auto intake = trySubmit(job);
+            if (intake != Intake::Full)
+                return intake;
+
+            waitForRoom(ProgressSignal::Clock::time_point::max());
+        }
+    }
+
+    /*
+     * Parses job on the calling thread, concurrently with any drain; only for
+     * parsers without per-call state. Returns false, leaving job untouched,
+     * while the reorder window is full.
+     */
+    bool processInline(SliceJob &job)
+    {
+        if (m_window && job.sequence == 0)
+        {
+            if (!m_window->hasSpace())
+                return false;
+
+            job.sequence = m_window->acquire();
+        }
+
+        ParsedSlice slice;
+        slice.sequence = job.sequence;
+        slice.origin = this;
+        processJob(job, slice);
+
+        if (m_window && slice.sequence != 0)
+            m_window->deposit(std::move(slice));
+        else
+            deliver(slice);
+
+        return true;
+    }
+
+    static bool isValidSlice(const QSharedPointer<QByteArray> &buffer, int offset, int length)
+    {
+        return buffer && offset >= 0 && length > 0 && offset <= buffer->size() && length <= buffer->size() - offset;
+    }
+
+    SliceWorkerStats stats() const
+    {
+        return {m_jobs.load(std::memory_order_relaxed), m_batches.load(std::memory_order_relaxed), m_wakeups.load(std::memory_order_relaxed),
+                m_busyNanos.load(std::memory_order_relaxed)};
+    }
+
+    size_t queueDepth() const
+    {
+        return m_queue.size();
+    }
+
+    // No job queued or being processed; only meaningful while nothing is submitted concurrently.
+    bool isIdle() const
+    {
+        return m_queue.isEmpty() && m_drain->state.load() == DrainState::Idle;
+    }
+
+    // Sizing state shared by the workers of one pool; see ParserConcurrencyController.
+    void setConcurrency(std::shared_ptr<ParserConcurrencyController> concurrency)
+    {
+        m_concurrency = std::move(concurrency);
+    }
+
+    ParserConcurrencyController *concurrency() const
+    {
+        return m_concurrency.get();
+    }
+
+    // ParserQueue budget shared by all workers of a device; set before the first job is submitted.
+    void setQueueBudget(std::shared_ptr<StageBudget> budget)
+    {
+        m_budget = std::move(budget);
+    }
+
+    // Shared by all workers of a device; set before the first job is submitted.
+    void setReorderWindow(std::shared_ptr<ReorderWindow> window)
+    {
+        m_window = std::move(window);
+    }
+
+    ReorderWindow *reorderWindow() const
+    {
+        return m_window.get();
+    }
+
+  protected:
+    virtual void processJob(const SliceJob &job, ParsedSlice &slice) = 0;
+
+    void deliver(ParsedSlice &slice) const
+    {
+        if (m_handler)
+            m_handler(slice);
+    }
+
+    // Reports a slice that was rejected before it was queued.
+    void reject(EventError error, EventPacketType type) const
+    {
+        ParsedSlice slice;
+        slice.origin = this;
+        slice.failed(error, type);
+        deliver(slice);
+    }
+
+    // Whether a DropWaveformsFirst queue may discard job before other jobs.
+    virtual bool isWaveformJob(const SliceJob &job) const
+    {
+        Q_UNUSED(job)
+        return false;
+    }
+
+    // Stops intake, discards queued jobs and waits for a queued or running drain to finish.
+    void shutdown()
+    {
+        m_closing.store(true);
+
+        for (auto state = m_drain->state.load(); state != DrainState::Idle; state = m_drain->state.load())
+            m_drain->state.wait(state);
+
+        if (m_window)
+            m_window->detach(this);
+    }
+
+  private:
+    static qint64 jobBytes(const SliceJob &job)
+    {
+        return (job.offset >= 0 ? std::max(job.length, 0) : 0) + (job.pairOffset >= 0 ? std::max(job.pairLength, 0) : 0);
+    }
+
+    enum class Stall
+    {
+        None,
+        Ring,
+        Window,
+        Budget
+    };
+
+    // Counts one blocked job per stall, not one per retry.
+    Intake stall(Stall cause, quint64 epoch)
+    {
+        if (m_stall == Stall::None)
+        {
+            if (cause == Stall::Window)
+                m_window->countFullWait();
+            else if (m_budget)
+                m_budget->countBlock();
+        }
+
+        m_stall = cause;
+        m_stallEpoch = epoch;
+
+        // The consumers free the room; make sure one is running.
+        wake();
+        return Intake::Full;
+    }
+
+    bool evicts(const SliceJob &job) const
+    {
+        if (!m_budget || !m_budget->isFull())
+            return false;
+
+        const auto policy = m_budget->limit().policy;
+        return policy == OverflowPolicy::DropOldest || (policy == OverflowPolicy::DropWaveformsFirst && isWaveformJob(job));
+    }
+
+    /*
+     * Drain scheduling state. It lives apart from the worker and is co-owned
+     * by the queued drain task, so the drain can still clear and notify it
+     * after shutdown() has seen Idle and the worker is gone.
+     */
+    struct DrainState
+    {
+        enum : int
+        {
+            Idle,
+            Running, // a drain is queued or running
+            Notified // as Running, and jobs were pushed since the drain last found the ring empty
+        };
+
+        std::atomic<int> state{Idle};
+    };
+
+    void wake()
+    {
+        if (m_closing.load(std::memory_order_relaxed) || m_drain->state.exchange(DrainState::Notified) != DrainState::Idle)
+            return;
+
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+
+        // After ParserExecutor::shutdown() the submitting thread drains the worker itself.
+        if (!ParserExecutor::instance().submit([this, drain = m_drain] { this->drain(*drain); }, reinterpret_cast<size_t>(this) / alignof(SliceWorker)))
+            drain(*m_drain);
+    }
+
+    void drain(DrainState &drain)
+    {
+        drain.state.store(DrainState::Running);
+
+        size_t processed = 0;
+        for (;;)
+        {
+            const auto count = drainAvailable();
+            processed += count;
+
+            if (count > 0)
+            {
+                if (processed < drainQuantum)
+                    continue;
+
+                if (ParserExecutor::instance().submit([this, drain = m_drain] { this->drain(*drain); }))
+                    return;
+
+                processed = 0;
+                continue;
+            }
+
+            // The worker may be destroyed as soon as the state reads Idle; touch nothing of it afterwards.
+            int expected = DrainState::Running;
+            if (drain.state.compare_exchange_strong(expected, DrainState::Idle))
+            {
+                drain.state.notify_all();
+                return;
+            }
+
+            drain.state.store(DrainState::Running);
+        }
+    }
+
+    // Processes (or, when closing, discards) one batch and returns its size.
+    size_t drainAvailable()
+    {
+        const auto count = m_queue.popBatch(m_batch, batchSize);
+        if (count == 0)
+            return 0;
+
+        m_consumed.notify();
+
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+
+        // Discarded jobs still hand their empty results to the window, so it does not wait for them.
+        const bool closing = m_closing.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ParsedSlice slice;
+            slice.sequence = m_batch[i].sequence;
+            slice.origin = this;
+
+            const bool evicted = !closing && evicts(m_batch[i]);
+            if (m_budget)
+            {
+                m_budget->release(jobBytes(m_batch[i]));
+                if (evicted)
+                    m_budget->countDrop(jobBytes(m_batch[i]));
+            }
+
+            if (!closing && !evicted)
+                processJob(m_batch[i], slice);
+
+            if (m_window && slice.sequence != 0)
+                m_ordered.push_back(std::move(slice));
+            else
+                deliver(slice);
+
+            m_batch[i] = {};
+        }
+
+        if (!m_ordered.empty())
+        {
+            m_window->deposit(m_ordered);
+            m_ordered.clear();
+        }
+
+        m_busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                              std::memory_order_relaxed);
+        return count;
+    }
+
+    SpscQueue<SliceJob> m_queue;
+    SliceJob m_batch[batchSize];
+
+    ProgressSignal m_consumed;
+    Stall m_stall{Stall::None};
+    quint64 m_stallEpoch{};
+    std::shared_ptr<DrainState> m_drain = std::make_shared<DrainState>();
+    std::atomic<bool> m_closing{false};
+
+    std::atomic<quint64> m_jobs{};
+    std::atomic<quint64> m_batches{};
+    std::atomic<quint64> m_wakeups{};
+    std::atomic<quint64> m_busyNanos{};
+
+    ParsedSliceHandler m_handler;
+    std::shared_ptr<ParserConcurrencyController> m_concurrency;
+    std::shared_ptr<ReorderWindow> m_window;
+    std::shared_ptr<StageBudget> m_budget;
+    std::vector<ParsedSlice> m_ordered;
+};
+
+} // namespace network
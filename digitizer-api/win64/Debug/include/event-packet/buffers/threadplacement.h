@@ -0,0 +1,346 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(Q_OS_LINUX) && __has_include(<sched.h>) && __has_include(<sys/syscall.h>)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define NETWORK_THREAD_PLACEMENT_HAS_AFFINITY 1
+#endif
+
+namespace network
+{
+
+/*
+ * NUMA-aware placement of the receive pipeline's threads and buffers.
+ *
+ * On multi-socket machines the scheduler is free to move the I/O, framing
+ * and parser threads away from the socket the NIC is attached to, and the
+ * receive slabs then live in remote memory. With a policy enabled, the
+ * pipeline resolves the NUMA node of the NIC (or takes an explicit one) and
+ *  - pins each I/O and framing thread to one of the node's first
+ *    reservedCores cores, taken in turn;
+ *  - restricts the parser threads to the node's remaining cores (all of
+ *    them if the node is too small), and sizes the ParserExecutor to match;
+ *  - binds new receive slabs to the node's memory.
+ *
+ * Parser threads pin themselves when the executor starts them. I/O and
+ * framing threads are pinned by whoever starts them, calling
+ * pinCurrentThread() once on the new thread (the I/O reactors, the io_uring
+ * ingest thread); nothing on the data path pins implicitly.
+ *
+ * The node and its CPUs come from sysfs. Placement is best effort: without
+ * NUMA information, on other platforms or when the kernel refuses, threads
+ * and memory stay where the scheduler puts them and stats() counts the
+ * failure. Set the policy before the first device is connected; threads
+ * apply it when they start, and the ParserExecutor is sized on first use.
+ */
+
+enum class ThreadRole
+{
+    Io,      // socket reads (NetworkWorker)
+    Framing, // packet framing (the thread that feeds the parser workers)
+    Parser   // ParserExecutor threads
+};
+
+struct ThreadPlacementPolicy
+{
+    bool enabled{false};
+    QString networkInterface; // interface whose NUMA node is used, e.g. "enp65s0f0"
+    int numaNode{-1};         // used instead of the interface's node when >= 0
+    int reservedCores{2};     // cores of the node kept for I/O and framing threads
+    bool pinIo{true};
+    bool pinFraming{true};
+    bool pinParsers{true};
+    bool nodeLocalSlabs{true};
+};
+
+struct ThreadPlacementStats
+{
+    int node{-1};
+    int nodeCpus{};
+    quint64 pinnedIo{};
+    quint64 pinnedFraming{};
+    quint64 pinnedParsers{};
+    quint64 boundBytes{};
+    quint64 failures{};
+};
+
+class ThreadPlacement final
+{
+  public:
+    static ThreadPlacement &instance()
+    {
+        static ThreadPlacement placement;
+        return placement;
+    }
+
+    // Resolves the node and its CPUs from sysfs right away.
+    void setPolicy(const ThreadPlacementPolicy &policy)
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_policy = policy;
+        m_node = -1;
+        m_cpus.clear();
+
+        if (!policy.enabled)
+            return;
+
+        m_node = policy.numaNode >= 0 ? policy.numaNode : nodeOfInterface(policy.networkInterface);
+        if (m_node >= 0)
+            m_cpus = cpusOfNode(m_node);
+
+        if (m_cpus.empty())
+        {
+            m_node = -1;
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    ThreadPlacementPolicy policy() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_policy;
+    }
+
+    // Node in use, -1 while placement is off or unresolved.
+    int node() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_node;
+    }
+
+    // Threads the ParserExecutor should start: the node's parser cores, 0 for the default.
+    int parserThreadCount() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_node >= 0 && m_policy.pinParsers ? static_cast<int>(parserCpusLocked().size()) : 0;
+    }
+
+    // Pins the calling thread according to its role; returns whether it was pinned.
+    bool pinCurrentThread(ThreadRole role)
+    {
+        std::vector<int> cpus;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_node < 0)
+                return false;
+
+            switch (role)
+            {
+            case ThreadRole::Io:
+            case ThreadRole::Framing: {
+                if (!(role == ThreadRole::Io ? m_policy.pinIo : m_policy.pinFraming))
+                    return false;
+
+                const auto reserved = std::clamp<size_t>(static_cast<size_t>(std::max(m_policy.reservedCores, 1)), 1, m_cpus.size());
+                cpus.push_back(m_cpus[m_nextReserved++ % reserved]);
+                break;
+            }
+            case ThreadRole::Parser:
+                if (!m_policy.pinParsers)
+                    return false;
+
+                cpus = parserCpusLocked();
+                break;
+            }
+        }
+
+        if (!setAffinity(cpus))
+        {
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        switch (role)
+        {
+        case ThreadRole::Io:
+            m_pinnedIo.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case ThreadRole::Framing:
+            m_pinnedFraming.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case ThreadRole::Parser:
+            m_pinnedParsers.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+
+        return true;
+    }
+
+    /*
+     * Prefers the node's memory for the whole pages in [data, data + size).
+     * Call it before the pages are first written: untouched pages are then
+     * faulted in on the node, whichever thread writes them.
+     */
+    bool bindToNode(void *data, size_t size)
+    {
+        int node = -1;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_policy.nodeLocalSlabs)
+                node = m_node;
+        }
+
+        if (node < 0 || !data || size == 0)
+            return false;
+
+        if (!bindMemory(data, size, node))
+        {
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_boundBytes.fetch_add(size, std::memory_order_relaxed);
+        return true;
+    }
+
+    ThreadPlacementStats stats() const
+    {
+        std::lock_guard lock(m_mutex);
+        return {m_node,
+                static_cast<int>(m_cpus.size()),
+                m_pinnedIo.load(std::memory_order_relaxed),
+                m_pinnedFraming.load(std::memory_order_relaxed),
+                m_pinnedParsers.load(std::memory_order_relaxed),
+                m_boundBytes.load(std::memory_order_relaxed),
+                m_failures.load(std::memory_order_relaxed)};
+    }
+
+    // NUMA node of a network interface, -1 if unknown (virtual devices, single-node machines).
+    static int nodeOfInterface(const QString &interface)
+    {
+        if (interface.isEmpty())
+            return -1;
+
+        std::ifstream file("/sys/class/net/" + interface.toStdString() + "/device/numa_node");
+        int node = -1;
+        if (!(file >> node))
+            return -1;
+
+        return node;
+    }
+
+    static std::vector<int> cpusOfNode(int node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!std::getline(file, list))
+            return {};
+
+        return parseCpuList(list);
+    }
+
+    // Parses a kernel CPU list such as "0-15,32-47".
+    static std::vector<int> parseCpuList(const std::string &list)
+    {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+
+        while (std::getline(stream, range, ','))
+        {
+            int first = -1;
+            int last = -1;
+            const auto dash = range.find('-');
+
+            try
+            {
+                first = std::stoi(range.substr(0, dash));
+                last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            }
+            catch (const std::exception &)
+            {
+                continue;
+            }
+
+            for (int cpu = first; cpu >= 0 && cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+  private:
+    ThreadPlacement() = default;
+
+    std::vector<int> parserCpusLocked() const
+    {
+        const auto reserved = static_cast<size_t>(std::max(m_policy.reservedCores, 0));
+        if (m_cpus.size() <= reserved)
+            return m_cpus;
+
+        return std::vector<int>(m_cpus.begin() + static_cast<std::ptrdiff_t>(reserved), m_cpus.end());
+    }
+
+    static bool setAffinity(const std::vector<int> &cpus)
+    {
+#ifdef NETWORK_THREAD_PLACEMENT_HAS_AFFINITY
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const auto cpu : cpus)
+        {
+            if (cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+
+        return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        Q_UNUSED(cpus)
+        return false;
+#endif
+    }
+
+    static bool bindMemory(void *data, size_t size, int node)
+    {
+#if defined(NETWORK_THREAD_PLACEMENT_HAS_AFFINITY) && defined(SYS_mbind)
+        // Only whole pages can carry a policy; the partial ones at either end follow first touch.
+        const auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const auto begin = (reinterpret_cast<uintptr_t>(data) + page - 1) & ~(page - 1);
+        const auto end = (reinterpret_cast<uintptr_t>(data) + size) & ~(page - 1);
+        if (end <= begin)
+            return true;
+
+        constexpr int preferredPolicy = 1; // MPOL_PREFERRED
+        constexpr unsigned long bitsPerWord = 8 * sizeof(unsigned long);
+
+        std::vector<unsigned long> mask(static_cast<size_t>(node) / bitsPerWord + 1);
+        mask[static_cast<size_t>(node) / bitsPerWord] = 1ul << (static_cast<size_t>(node) % bitsPerWord);
+
+        return syscall(SYS_mbind, begin, end - begin, preferredPolicy, mask.data(), mask.size() * bitsPerWord + 1, 0) == 0;
+#else
+        Q_UNUSED(data)
+        Q_UNUSED(size)
+        Q_UNUSED(node)
+        return false;
+#endif
+    }
+
+    mutable std::mutex m_mutex;
+    ThreadPlacementPolicy m_policy;
+    int m_node{-1};
+    std::vector<int> m_cpus;
+    size_t m_nextReserved{};
+
+    std::atomic<quint64> m_pinnedIo{};
+    std::atomic<quint64> m_pinnedFraming{};
+    std::atomic<quint64> m_pinnedParsers{};
+    std::atomic<quint64> m_boundBytes{};
+    std::atomic<quint64> m_failures{};
+};
+
+} // namespace network
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -41,21 +42,12 @@ struct DetectronStatisticNetworkPacket
 {
     static size_t size()
     {
-        return 56;
+        return Layout::size();
     }
 
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId
-
-            >> anodeTriggers >> anodeProcessed
-            >> x1Triggers >> x1Processed
-            >> x2Triggers >> x2Processed
-            >> y1Triggers >> y1Processed
-            >> y2Triggers >> y2Processed
-            >> cntMonitor >> padding >> checksum;
-
-        return in;
+        return Layout::read(in, *this);
     }
 
     //[HEADER]
@@ -83,6 +75,28 @@ struct DetectronStatisticNetworkPacket
     quint32 cntMonitor{};
     quint16 padding{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &DetectronStatisticNetworkPacket::deviceId, 0>,
+                              WireField<"packetType", &DetectronStatisticNetworkPacket::packetType, 4>,
+                              WireField<"flags", &DetectronStatisticNetworkPacket::flags, 5>,
+                              WireField<"channelId", &DetectronStatisticNetworkPacket::channelId, 6>,
+                              WireField<"anodeTriggers", &DetectronStatisticNetworkPacket::anodeTriggers, 8>,
+                              WireField<"anodeProcessed", &DetectronStatisticNetworkPacket::anodeProcessed, 12>,
+                              WireField<"x1Triggers", &DetectronStatisticNetworkPacket::x1Triggers, 16>,
+                              WireField<"x1Processed", &DetectronStatisticNetworkPacket::x1Processed, 20>,
+                              WireField<"x2Triggers", &DetectronStatisticNetworkPacket::x2Triggers, 24>,
+                              WireField<"x2Processed", &DetectronStatisticNetworkPacket::x2Processed, 28>,
+                              WireField<"y1Triggers", &DetectronStatisticNetworkPacket::y1Triggers, 32>,
+                              WireField<"y1Processed", &DetectronStatisticNetworkPacket::y1Processed, 36>,
+                              WireField<"y2Triggers", &DetectronStatisticNetworkPacket::y2Triggers, 40>,
+                              WireField<"y2Processed", &DetectronStatisticNetworkPacket::y2Processed, 44>,
+                              WireField<"cntMonitor", &DetectronStatisticNetworkPacket::cntMonitor, 48>,
+                              WireField<"padding", &DetectronStatisticNetworkPacket::padding, 52>,
+                              WireField<"checksum", &DetectronStatisticNetworkPacket::checksum, 54>>;
 };
 
+static_assert(DetectronStatisticNetworkPacket::Layout::size() == 56);
+static_assert(DetectronStatisticNetworkPacket::Layout::isContiguous());
+
 } // namespace network
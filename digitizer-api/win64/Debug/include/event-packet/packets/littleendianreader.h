@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QDataStream>
+#include <QIODevice>
+#include <QtEndian>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Sequential little-endian reader over a borrowed byte range.
+ *
+ * Mirrors the subset of the QDataStream interface used by the packet
+ * deserialize() chains (operator>>, readRawData, skipRawData, status), so the same
+ * templated deserialize() body decodes either from a stream or straight
+ * from the receive buffer without copying it. readArray() decodes a whole
+ * sample array in one block; the byte swap only happens on big-endian hosts.
+ */
+
+class LittleEndianReader final
+{
+  public:
+    enum class Status
+    {
+        Ok,
+        ReadPastEnd
+    };
+
+    explicit LittleEndianReader(QByteArrayView data) : m_data(reinterpret_cast<const uchar *>(data.constData())), m_size(data.size())
+    {
+    }
+
+    template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    LittleEndianReader &operator>>(T &value)
+    {
+        if (m_status != Status::Ok || m_size - m_pos < static_cast<qsizetype>(sizeof(T)))
+        {
+            m_status = Status::ReadPastEnd;
+            value = T{};
+            return *this;
+        }
+
+        if constexpr (std::is_enum_v<T>)
+            value = static_cast<T>(qFromLittleEndian<std::underlying_type_t<T>>(m_data + m_pos));
+        else
+            value = qFromLittleEndian<T>(m_data + m_pos);
+
+        m_pos += sizeof(T);
+        return *this;
+    }
+
+    template <typename T, typename Allocator>
+        requires std::is_arithmetic_v<T>
+    LittleEndianReader &readArray(std::vector<T, Allocator> &values, quint32 count)
+    {
+        const auto bytes = static_cast<qsizetype>(count) * static_cast<qsizetype>(sizeof(T));
+        if (m_status != Status::Ok || m_size - m_pos < bytes)
+        {
+            m_status = Status::ReadPastEnd;
+            values.clear();
+            return *this;
+        }
+
+        values.resize(count);
+        if (count > 0)
+            qFromLittleEndian<T>(m_data + m_pos, count, values.data());
+
+        m_pos += bytes;
+        return *this;
+    }
+
+    int skipRawData(int len)
+    {
+        if (m_status != Status::Ok || len < 0 || m_size - m_pos < len)
+        {
+            m_status = Status::ReadPastEnd;
+            return -1;
+        }
+
+        m_pos += len;
+        return len;
+    }
+
+    int readRawData(char *data, int len)
+    {
+        if (m_status != Status::Ok || len < 0 || m_size - m_pos < len)
+        {
+            m_status = Status::ReadPastEnd;
+            return -1;
+        }
+
+        std::memcpy(data, m_data + m_pos, static_cast<size_t>(len));
+        m_pos += len;
+        return len;
+    }
+
+    Status status() const
+    {
+        return m_status;
+    }
+
+    qsizetype position() const
+    {
+        return m_pos;
+    }
+
+  private:
+    const uchar *m_data{};
+    qsizetype m_size{};
+    qsizetype m_pos{};
+    Status m_status{Status::Ok};
+};
+
+template <typename T, typename Allocator> QDataStream &readArray(QDataStream &in, std::vector<T, Allocator> &values, quint32 count)
+{
+    // count comes off the wire; do not allocate for more samples than the stream can still deliver.
+    const auto bytes = static_cast<qint64>(count) * static_cast<qint64>(sizeof(T));
+    if (in.status() != QDataStream::Ok || !in.device() || in.device()->bytesAvailable() < bytes)
+    {
+        in.setStatus(QDataStream::ReadPastEnd);
+        values.clear();
+        return in;
+    }
+
+    values.resize(count);
+    for (auto &value : values)
+        in >> value;
+
+    return in;
+}
+
+template <typename T, typename Allocator> LittleEndianReader &readArray(LittleEndianReader &in, std::vector<T, Allocator> &values, quint32 count)
+{
+    return in.readArray(values, count);
+}
+
+} // namespace network
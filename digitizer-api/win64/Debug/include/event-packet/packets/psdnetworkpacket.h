@@ -1,6 +1,7 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -35,20 +36,12 @@ struct PsdNetworkPacket
 {
     static size_t size()
     {
-        return 48;
+        return Layout::size();
     }
 
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc >> qShort >> qLong >> cfdY1 >> cfdY2 >> baseline >> height >> eventCounter >>
-            eventCounterPsd >> psdValue;
-
-        for (auto &res : reserved)
-            in >> res;
-
-        in >> checksum;
-
-        return in;
+        return Layout::read(in, *this);
     }
 
     //[HEADER]
@@ -69,6 +62,27 @@ struct PsdNetworkPacket
     qint16 psdValue{};
     quint16 reserved[2]{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &PsdNetworkPacket::deviceId, 0>,
+                              WireField<"packetType", &PsdNetworkPacket::packetType, 4>,
+                              WireField<"flags", &PsdNetworkPacket::flags, 5>,
+                              WireField<"channelId", &PsdNetworkPacket::channelId, 6>,
+                              WireField<"rtc", &PsdNetworkPacket::rtc, 8>,
+                              WireField<"qShort", &PsdNetworkPacket::qShort, 16>,
+                              WireField<"qLong", &PsdNetworkPacket::qLong, 20>,
+                              WireField<"cfdY1", &PsdNetworkPacket::cfdY1, 24>,
+                              WireField<"cfdY2", &PsdNetworkPacket::cfdY2, 26>,
+                              WireField<"baseline", &PsdNetworkPacket::baseline, 28>,
+                              WireField<"height", &PsdNetworkPacket::height, 30>,
+                              WireField<"eventCounter", &PsdNetworkPacket::eventCounter, 32>,
+                              WireField<"eventCounterPsd", &PsdNetworkPacket::eventCounterPsd, 36>,
+                              WireField<"psdValue", &PsdNetworkPacket::psdValue, 40>,
+                              WireField<"reserved", &PsdNetworkPacket::reserved, 42>,
+                              WireField<"checksum", &PsdNetworkPacket::checksum, 46>>;
 };
 
+static_assert(PsdNetworkPacket::Layout::size() == 48);
+static_assert(PsdNetworkPacket::Layout::isContiguous());
+
 } // namespace network
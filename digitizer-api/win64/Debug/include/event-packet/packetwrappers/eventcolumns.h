@@ -0,0 +1,227 @@
+#pragma once
+
+#include "packets/eventpackettype.h"
+#include "packets/phanetworkpacket.h"
+#include "packets/psdnetworkpacket.h"
+#include "packets/psdnetworkpacketv2.h"
+
+#include <QtGlobal>
+
+#include <concepts>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Structure-of-arrays batches of PSD and PHA events.
+ *
+ * A batch holds events of one device and packet type; element i of every
+ * column belongs to event i. Cuts and histograms over a field then run over
+ * one contiguous array, which the compiler can vectorize, instead of
+ * visiting an EventPacket per event.
+ *
+ * append() takes either a parsed packet or the packet's wire bytes; the
+ * latter decodes each field through the packet's Layout straight into its
+ * column, which is what PacketParser::parseInto() does. clear() keeps the
+ * capacity, so a batch that is filled and cleared in a loop stops
+ * allocating once it has reached its working size.
+ */
+
+template <typename Packet>
+concept PsdColumnarPacket = std::is_same_v<Packet, PsdNetworkPacket> || std::is_same_v<Packet, PsdNetworkPacketV2>;
+
+template <typename Packet>
+concept ColumnarPacket = PsdColumnarPacket<Packet> || std::is_same_v<Packet, PhaNetworkPacket>;
+
+struct PsdColumns
+{
+    quint32 deviceId{};
+    EventPacketType packetType{EventPacketType::PsdEventInfo};
+
+    std::vector<quint8> flags;
+    std::vector<quint16> channelId;
+    std::vector<quint64> rtc;
+    std::vector<qint32> qShort;
+    std::vector<qint32> qLong;
+    std::vector<qint16> cfdY1;
+    std::vector<qint16> cfdY2;
+    std::vector<qint16> baseline;
+    std::vector<qint16> height;
+    std::vector<quint32> eventCounter;
+    std::vector<quint32> eventCounterPsd;
+    std::vector<qint16> psdValue;
+    std::vector<quint16> channelIdDouble; // PsdEventInfoV2 only, empty otherwise
+    std::vector<quint16> spectrumBin;     // PsdEventInfoV2 only, empty otherwise
+
+    size_t size() const
+    {
+        return rtc.size();
+    }
+
+    bool empty() const
+    {
+        return rtc.empty();
+    }
+
+    template <typename Function> void forEachColumn(Function &&function)
+    {
+        function(flags);
+        function(channelId);
+        function(rtc);
+        function(qShort);
+        function(qLong);
+        function(cfdY1);
+        function(cfdY2);
+        function(baseline);
+        function(height);
+        function(eventCounter);
+        function(eventCounterPsd);
+        function(psdValue);
+        function(channelIdDouble);
+        function(spectrumBin);
+    }
+
+    void reserve(size_t count)
+    {
+        forEachColumn([count](auto &column) { column.reserve(count); });
+    }
+
+    void clear()
+    {
+        forEachColumn([](auto &column) { column.clear(); });
+    }
+
+    // The caller guarantees Packet::size() readable bytes.
+    template <PsdColumnarPacket Packet> void append(const uchar *wire)
+    {
+        using Layout = typename Packet::Layout;
+
+        flags.push_back(Layout::template load<&Packet::flags>(wire));
+        channelId.push_back(Layout::template load<&Packet::channelId>(wire));
+        rtc.push_back(Layout::template load<&Packet::rtc>(wire));
+        qShort.push_back(Layout::template load<&Packet::qShort>(wire));
+        qLong.push_back(Layout::template load<&Packet::qLong>(wire));
+        cfdY1.push_back(Layout::template load<&Packet::cfdY1>(wire));
+        cfdY2.push_back(Layout::template load<&Packet::cfdY2>(wire));
+        baseline.push_back(Layout::template load<&Packet::baseline>(wire));
+        height.push_back(Layout::template load<&Packet::height>(wire));
+        eventCounter.push_back(Layout::template load<&Packet::eventCounter>(wire));
+        eventCounterPsd.push_back(Layout::template load<&Packet::eventCounterPsd>(wire));
+        psdValue.push_back(Layout::template load<&Packet::psdValue>(wire));
+
+        if constexpr (std::is_same_v<Packet, PsdNetworkPacketV2>)
+        {
+            channelIdDouble.push_back(Layout::template load<&Packet::channelIdDouble>(wire));
+            spectrumBin.push_back(Layout::template load<&Packet::spectrumBin>(wire));
+        }
+    }
+
+    template <PsdColumnarPacket Packet> void append(const Packet &packet)
+    {
+        flags.push_back(packet.flags);
+        channelId.push_back(packet.channelId);
+        rtc.push_back(packet.rtc);
+        qShort.push_back(packet.qShort);
+        qLong.push_back(packet.qLong);
+        cfdY1.push_back(packet.cfdY1);
+        cfdY2.push_back(packet.cfdY2);
+        baseline.push_back(packet.baseline);
+        height.push_back(packet.height);
+        eventCounter.push_back(packet.eventCounter);
+        eventCounterPsd.push_back(packet.eventCounterPsd);
+        psdValue.push_back(packet.psdValue);
+
+        if constexpr (std::is_same_v<Packet, PsdNetworkPacketV2>)
+        {
+            channelIdDouble.push_back(packet.channelIdDouble);
+            spectrumBin.push_back(packet.spectrumBin);
+        }
+    }
+};
+
+struct PhaColumns
+{
+    quint32 deviceId{};
+    EventPacketType packetType{EventPacketType::PhaEventInfo};
+
+    std::vector<quint8> flags;
+    std::vector<quint16> channelId;
+    std::vector<quint64> rtc;
+    std::vector<qint64> trapBaseline;
+    std::vector<qint64> trapHeightMean;
+    std::vector<qint64> trapHeightMax;
+    std::vector<quint32> eventCounter;
+    std::vector<qint16> rcCr2Y1;
+    std::vector<qint16> rcCr2Y2;
+
+    size_t size() const
+    {
+        return rtc.size();
+    }
+
+    bool empty() const
+    {
+        return rtc.empty();
+    }
+
+    template <typename Function> void forEachColumn(Function &&function)
+    {
+        function(flags);
+        function(channelId);
+        function(rtc);
+        function(trapBaseline);
+        function(trapHeightMean);
+        function(trapHeightMax);
+        function(eventCounter);
+        function(rcCr2Y1);
+        function(rcCr2Y2);
+    }
+
+    void reserve(size_t count)
+    {
+        forEachColumn([count](auto &column) { column.reserve(count); });
+    }
+
+    void clear()
+    {
+        forEachColumn([](auto &column) { column.clear(); });
+    }
+
+    // The caller guarantees PhaNetworkPacket::size() readable bytes.
+    template <std::same_as<PhaNetworkPacket> Packet> void append(const uchar *wire)
+    {
+        using Layout = typename Packet::Layout;
+
+        flags.push_back(Layout::template load<&Packet::flags>(wire));
+        channelId.push_back(Layout::template load<&Packet::channelId>(wire));
+        rtc.push_back(Layout::template load<&Packet::rtc>(wire));
+        trapBaseline.push_back(Layout::template load<&Packet::trapBaseline>(wire));
+        trapHeightMean.push_back(Layout::template load<&Packet::trapHeightMean>(wire));
+        trapHeightMax.push_back(Layout::template load<&Packet::trapHeightMax>(wire));
+        eventCounter.push_back(Layout::template load<&Packet::eventCounter>(wire));
+        rcCr2Y1.push_back(Layout::template load<&Packet::rcCr2Y1>(wire));
+        rcCr2Y2.push_back(Layout::template load<&Packet::rcCr2Y2>(wire));
+    }
+
+    template <std::same_as<PhaNetworkPacket> Packet> void append(const Packet &packet)
+    {
+        flags.push_back(packet.flags);
+        channelId.push_back(packet.channelId);
+        rtc.push_back(packet.rtc);
+        trapBaseline.push_back(packet.trapBaseline);
+        trapHeightMean.push_back(packet.trapHeightMean);
+        trapHeightMax.push_back(packet.trapHeightMax);
+        eventCounter.push_back(packet.eventCounter);
+        rcCr2Y1.push_back(packet.rcCr2Y1);
+        rcCr2Y2.push_back(packet.rcCr2Y2);
+    }
+};
+
+// Column batch type of Packet; std::monostate for packets without one.
+template <typename Packet>
+using ColumnsOf = std::conditional_t<PsdColumnarPacket<Packet>, PsdColumns, std::conditional_t<std::is_same_v<Packet, PhaNetworkPacket>, PhaColumns, std::monostate>>;
+
+} // namespace network
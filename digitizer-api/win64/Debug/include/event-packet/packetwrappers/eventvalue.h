@@ -0,0 +1,176 @@
+#pragma once
+
+#include "eventpacketheader.h"
+
+#include "buffers/networkpacket.h"
+#include "buffers/payloadpool.h"
+#include "packets/devicespectrum16.h"
+#include "packets/devicespectrum32.h"
+#include "packets/phanetworkpacket.h"
+#include "packets/psdnetworkpacket.h"
+#include "packets/psdnetworkpacketv2.h"
+#include "packets/spectrumtype.h"
+#include "packets/waveformnetworkpacket.h"
+
+#include <algorithm>
+#include <any>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+namespace network
+{
+
+/*
+ * Plain value types for the per-event data path.
+ *
+ * The EventPacket classes are QObjects: every event pays for a
+ * QObjectPrivate, a vtable and a qobject_cast at the consumer. These types
+ * carry the same fields without any of that. PSD and PHA events are
+ * trivially copyable; waveforms and spectra share their samples through a
+ * PooledArray, so copying an event never copies samples and the samples
+ * return to the device's PayloadPool with the last copy.
+ *
+ * An EventRecord is the value counterpart of EventData: the info event and
+ * the waveform recorded with it, if any. Consumers dispatch with
+ * std::get_if or std::visit. EventValueSink delivers them; the QObject
+ * packets remain available through eventvaluecompat.h.
+ */
+
+struct PsdEvent
+{
+    EventPacketHeader header;
+    qint32 qShort;
+    qint32 qLong;
+    qint16 cfdY1;
+    qint16 cfdY2;
+    qint16 baseline;
+    qint16 height;
+    quint32 eventCounter;
+    quint32 eventCounterPsd;
+    qint16 psdValue;
+};
+
+struct PhaEvent
+{
+    EventPacketHeader header;
+    qint64 trapBaseline;
+    qint64 trapHeightMean;
+    qint64 trapHeightMax;
+    quint32 eventCounter;
+    qint16 rcCr2Y1;
+    qint16 rcCr2Y2;
+};
+
+struct WaveformEvent
+{
+    EventPacketHeader header;
+    quint16 decimationFactor;
+    PooledArray<qint16> samples;
+};
+
+struct SpectrumEvent
+{
+    EventPacketHeader header;
+    SpectrumType spectrumType;
+    PooledArray<qint32> bins;
+};
+
+static_assert(std::is_trivially_copyable_v<PsdEvent>);
+static_assert(std::is_trivially_copyable_v<PhaEvent>);
+
+using EventValue = std::variant<PsdEvent, PhaEvent, WaveformEvent, SpectrumEvent>;
+
+struct EventRecord
+{
+    EventValue info;
+    std::optional<WaveformEvent> waveform;
+};
+
+inline const EventPacketHeader &headerOf(const EventValue &value)
+{
+    return std::visit([](const auto &event) -> const EventPacketHeader & { return event.header; }, value);
+}
+
+template <typename Packet> EventPacketHeader eventHeader(const Packet &packet, EventPacketType type)
+{
+    return {.deviceId = packet.deviceId, .packetType = type, .flags = packet.flags, .channelId = packet.channelId, .rtc = packet.rtc};
+}
+
+template <typename Packet>
+    requires std::is_same_v<Packet, PsdNetworkPacket> || std::is_same_v<Packet, PsdNetworkPacketV2>
+PsdEvent toEvent(const Packet &packet)
+{
+    return {eventHeader(packet, EventPacketType::PsdEventInfo),
+            packet.qShort,
+            packet.qLong,
+            packet.cfdY1,
+            packet.cfdY2,
+            packet.baseline,
+            packet.height,
+            packet.eventCounter,
+            packet.eventCounterPsd,
+            packet.psdValue};
+}
+
+inline PhaEvent toEvent(const PhaNetworkPacket &packet)
+{
+    return {eventHeader(packet, packet.packetType), packet.trapBaseline, packet.trapHeightMean, packet.trapHeightMax,
+            packet.eventCounter,                    packet.rcCr2Y1,      packet.rcCr2Y2};
+}
+
+// Samples go into pool when there is one, otherwise into the heap.
+template <typename Sample, typename Source> PooledArray<Sample> toPooledArray(const std::vector<Source> &source, PayloadPool *pool)
+{
+    auto samples = pool ? pool->makeArray<Sample>(source.size()) : std::make_shared<std::pmr::vector<Sample>>(source.size());
+    std::ranges::transform(source, samples->begin(), [](auto value) { return static_cast<Sample>(value); });
+    return samples;
+}
+
+inline WaveformEvent toEvent(const WaveformNetworkPacket &packet, PayloadPool *pool)
+{
+    return {eventHeader(packet, packet.packetType), packet.decimationFactor, toPooledArray<qint16>(packet.array, pool)};
+}
+
+template <typename Packet>
+    requires std::is_same_v<Packet, DeviceSpectrum16> || std::is_same_v<Packet, DeviceSpectrum32>
+SpectrumEvent toEvent(const Packet &packet, PayloadPool *pool)
+{
+    return {eventHeader(packet, packet.packetType), static_cast<SpectrumType>(packet.spectrumType), toPooledArray<qint32>(packet.array, pool)};
+}
+
+// Converts a packet as emitted by the parser workers; nullopt for types without a value counterpart.
+inline std::optional<EventValue> toEventValue(const std::any &parsed, PayloadPool *pool = nullptr)
+{
+    if (const auto *packet = std::any_cast<PsdNetworkPacket>(&parsed))
+        return toEvent(*packet);
+    if (const auto *packet = std::any_cast<PsdNetworkPacketV2>(&parsed))
+        return toEvent(*packet);
+    if (const auto *packet = std::any_cast<PhaNetworkPacket>(&parsed))
+        return toEvent(*packet);
+    if (const auto *packet = std::any_cast<WaveformNetworkPacket>(&parsed))
+        return toEvent(*packet, pool);
+    if (const auto *packet = std::any_cast<DeviceSpectrum16>(&parsed))
+        return toEvent(*packet, pool);
+    if (const auto *packet = std::any_cast<DeviceSpectrum32>(&parsed))
+        return toEvent(*packet, pool);
+
+    return std::nullopt;
+}
+
+// Converts a packet as delivered by ReceivePipeline; nullopt for types without a value counterpart.
+inline std::optional<EventValue> toEventValue(const NetworkPacket &parsed, PayloadPool *pool = nullptr)
+{
+    return std::visit(
+        [pool](const auto &packet) -> std::optional<EventValue> {
+            if constexpr (requires { toEvent(packet); })
+                return toEvent(packet);
+            else if constexpr (requires { toEvent(packet, pool); })
+                return toEvent(packet, pool);
+            else
+                return std::nullopt;
+        },
+        parsed);
+}
+
+} // namespace network
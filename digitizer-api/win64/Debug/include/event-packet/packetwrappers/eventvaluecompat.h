@@ -0,0 +1,105 @@
+#pragma once
+
+#include "eventdata.h"
+#include "eventpacket.h"
+#include "eventvalue.h"
+
+#include <QSharedPointer>
+
+#include <optional>
+
+namespace network
+{
+
+/*
+ * Opt-in bridge between the value types and the QObject event packets, for
+ * consumers written against EventData. Each conversion allocates the
+ * QObject packets the value path avoids, so use it at the edges only.
+ */
+
+inline QSharedPointer<EventPacket> toEventPacket(const EventValue &value)
+{
+    return std::visit(
+        [](const auto &event) -> QSharedPointer<EventPacket> {
+            using Event = std::decay_t<decltype(event)>;
+
+            if constexpr (std::is_same_v<Event, PsdEvent>)
+            {
+                auto packet = QSharedPointer<PsdEventPacket>::create();
+                packet->setHeader(event.header);
+                packet->m_qShort = event.qShort;
+                packet->m_qLong = event.qLong;
+                packet->m_cfdY1 = event.cfdY1;
+                packet->m_cfdY2 = event.cfdY2;
+                packet->m_baseline = event.baseline;
+                packet->m_height = event.height;
+                packet->m_eventCounter = event.eventCounter;
+                packet->m_eventCounterPsd = event.eventCounterPsd;
+                packet->m_psdValue = event.psdValue;
+                return packet;
+            }
+            else if constexpr (std::is_same_v<Event, PhaEvent>)
+            {
+                auto packet = QSharedPointer<PhaEventPacket>::create();
+                packet->setHeader(event.header);
+                packet->m_trapBaseline = event.trapBaseline;
+                packet->m_trapHeightMean = event.trapHeightMean;
+                packet->m_trapHeightMax = event.trapHeightMax;
+                packet->m_eventCounter = event.eventCounter;
+                packet->m_rcCr2Y1 = event.rcCr2Y1;
+                packet->m_rcCr2Y2 = event.rcCr2Y2;
+                return packet;
+            }
+            else if constexpr (std::is_same_v<Event, WaveformEvent>)
+            {
+                auto packet = QSharedPointer<WaveformEventPacket>::create();
+                packet->setHeader(event.header);
+                packet->m_decimationFactor = event.decimationFactor;
+                if (event.samples)
+                    packet->m_waveform.assign(event.samples->begin(), event.samples->end());
+                return packet;
+            }
+            else
+            {
+                auto packet = QSharedPointer<SpectrumEventPacket>::create();
+                packet->setHeader(event.header);
+                packet->m_spectrumType = event.spectrumType;
+                if (event.bins)
+                    packet->m_spectrum.assign(event.bins->begin(), event.bins->end());
+                return packet;
+            }
+        },
+        value);
+}
+
+inline EventData toEventData(const EventRecord &record)
+{
+    if (std::holds_alternative<WaveformEvent>(record.info))
+        return {nullptr, toEventPacket(record.info)};
+
+    return {toEventPacket(record.info), record.waveform ? toEventPacket(*record.waveform) : nullptr};
+}
+
+inline std::optional<EventValue> toEventValue(const EventPacket &packet)
+{
+    if (const auto *psd = qobject_cast<const PsdEventPacket *>(&packet))
+    {
+        return PsdEvent{psd->header(),      psd->m_qShort,       psd->m_qLong,           psd->m_cfdY1,   psd->m_cfdY2, psd->m_baseline,
+                        psd->m_height,      psd->m_eventCounter, psd->m_eventCounterPsd, psd->m_psdValue};
+    }
+
+    if (const auto *pha = qobject_cast<const PhaEventPacket *>(&packet))
+    {
+        return PhaEvent{pha->header(), pha->m_trapBaseline, pha->m_trapHeightMean, pha->m_trapHeightMax, pha->m_eventCounter, pha->m_rcCr2Y1, pha->m_rcCr2Y2};
+    }
+
+    if (const auto *waveform = qobject_cast<const WaveformEventPacket *>(&packet))
+        return WaveformEvent{waveform->header(), waveform->m_decimationFactor, toPooledArray<qint16>(waveform->m_waveform, nullptr)};
+
+    if (const auto *spectrum = qobject_cast<const SpectrumEventPacket *>(&packet))
+        return SpectrumEvent{spectrum->header(), spectrum->m_spectrumType, toPooledArray<qint32>(spectrum->m_spectrum, nullptr)};
+
+    return std::nullopt;
+}
+
+} // namespace network
@@ -25,6 +25,15 @@ struct PacketSlice
     int length{};
 };
 
+/*
+ * PacketBuffer's framing stage, compiled into libnetworker. Received
+ * chunks are appended to m_buffer and framed bytes are removed from its
+ * front, so every consumed packet moves the bytes behind it; the layout
+ * stays as it is for the prebuilt library. Streams that need framing
+ * without that copy go through ReceivePipeline, whose FramingStage
+ * advances over receive slabs and only copies a packet that straddles two
+ * of them.
+ */
 class BufferProcessor final : public QObject
 {
     Q_OBJECT
@@ -0,0 +1,392 @@
+#pragma once
+
+#include "packets/eventpackettype.h"
+#include "sliceworker.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace network
+{
+
+/*
+ * Runtime sizing of the parser pools.
+ *
+ * A pool still creates m_parserPoolSize workers, but dispatch only feeds the
+ * first activeWorkers of them. The controller samples the pool while
+ * dispatching: queue depth of the active rings, busy time and job count of
+ * all workers. Each sampleInterval it grows the active set by half when the
+ * rings back up or the workers are busy, and shrinks it by one after
+ * shrinkAfterIntervals quiet intervals. A worker outside the active set gets
+ * no jobs, so it causes no drains and never allocates its ring.
+ *
+ * Pools of small fixed-size packets may also be parsed inline on the framing
+ * thread (dispatchSlice()). For such pools the controller times one dispatch
+ * in timingEvery, and in Hybrid mode parses inline while the measured parse
+ * costs the framing thread no more than inlineSlack times the measured
+ * hand-off to a worker; heavier types stay pooled. The effective size
+ * threshold follows from these measurements and is reported with the stats.
+ *
+ * Controllers are created per device and pool by ParserConcurrency, which
+ * also reports their state; the workers of a pool share ownership of theirs.
+ * ReceivePipeline attaches one to each of its parser pools and dispatches
+ * through dispatchSlice(); pools of fixed-size packets are inline-eligible.
+ */
+
+enum class ParseMode
+{
+    Pooled, // every slice goes to a worker
+    Inline, // slices of eligible pools are parsed on the framing thread
+    Hybrid  // eligible pools go inline while that is measured to be cheaper
+};
+
+struct ParserConcurrencyPolicy
+{
+    std::chrono::nanoseconds sampleInterval{std::chrono::milliseconds(100)};
+    int minWorkers{1};
+    size_t growQueueDepth{SliceWorker::batchSize}; // queued jobs per active worker
+    double growUtilization{0.75};                  // busy fraction per active worker
+    double shrinkUtilization{0.5};                 // busy fraction the remaining workers would carry
+    int shrinkAfterIntervals{10};
+    ParseMode parseMode{ParseMode::Hybrid};
+    double inlineSlack{2.0}; // inline parse cost allowed per unit of hand-off cost
+};
+
+struct ParserConcurrencyStats
+{
+    quint32 deviceId{};
+    EventPacketType infoType{EventPacketType::InvalidEventInfo};
+    EventPacketType waveType{EventPacketType::InvalidEventInfo}; // InvalidEventInfo for single-type pools
+    int activeWorkers{};
+    int maxWorkers{};
+    quint64 queueDepth{};
+    double utilization{}; // busy cores over the last interval
+    quint64 meanParseNanos{};
+    quint64 grows{};
+    quint64 shrinks{};
+    bool parseInline{};
+    int inlineSizeThreshold{}; // packet size of an inline-eligible pool, 0 otherwise
+    quint64 inlineJobs{};
+    quint64 inlineParseNanos{};
+    quint64 handoffNanos{};
+};
+
+class ParserConcurrencyController final
+{
+  public:
+    static constexpr quint32 sampleEvery = 256; // dispatches between two looks at the clock
+    static constexpr quint32 timingEvery = 64;  // dispatches between two timed ones
+
+    // inlinePacketSize is the size of a fixed-size packet that may be parsed inline, 0 if it may not.
+    ParserConcurrencyController(quint32 deviceId, EventPacketType infoType, EventPacketType waveType, int maxWorkers,
+                                const ParserConcurrencyPolicy &policy, int inlinePacketSize = 0)
+        : m_deviceId(deviceId), m_infoType(infoType), m_waveType(waveType), m_policy(policy), m_maxWorkers(std::max(maxWorkers, 1)),
+          m_inlinePacketSize(policy.parseMode == ParseMode::Pooled ? 0 : inlinePacketSize),
+          m_active(std::clamp(policy.minWorkers, 1, m_maxWorkers)), m_inline(m_inlinePacketSize > 0 && policy.parseMode == ParseMode::Inline),
+          m_lastSample(std::chrono::steady_clock::now())
+    {
+    }
+
+    // Dispatch side; called from the single thread that feeds the pool.
+    int onDispatch(const std::vector<SliceWorker *> &workers)
+    {
+        if (++m_dispatches % sampleEvery == 0)
+            sample(workers);
+
+        return std::clamp(m_active.load(std::memory_order_relaxed), 1, static_cast<int>(workers.size()));
+    }
+
+    bool parseInline() const
+    {
+        return m_inline.load(std::memory_order_relaxed);
+    }
+
+    // True for the dispatch just counted by onDispatch() if it should be timed.
+    bool timeDispatch() const
+    {
+        return m_inlinePacketSize > 0 && m_dispatches % timingEvery == 0;
+    }
+
+    void recordDispatch(bool inlined, quint64 nanos)
+    {
+        if (inlined)
+            m_inlineParseNanos.store(average(m_inlineParseNanos.load(std::memory_order_relaxed), nanos), std::memory_order_relaxed);
+        else
+            m_handoffNanos.store(average(m_handoffNanos.load(std::memory_order_relaxed), nanos), std::memory_order_relaxed);
+    }
+
+    void countInline()
+    {
+        m_inlineJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ParserConcurrencyStats stats() const
+    {
+        ParserConcurrencyStats stats;
+        stats.deviceId = m_deviceId;
+        stats.infoType = m_infoType;
+        stats.waveType = m_waveType;
+        stats.activeWorkers = m_active.load(std::memory_order_relaxed);
+        stats.maxWorkers = m_maxWorkers;
+        stats.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+        stats.utilization = m_utilization.load(std::memory_order_relaxed);
+        stats.meanParseNanos = m_meanParseNanos.load(std::memory_order_relaxed);
+        stats.grows = m_grows.load(std::memory_order_relaxed);
+        stats.shrinks = m_shrinks.load(std::memory_order_relaxed);
+        stats.parseInline = parseInline();
+        stats.inlineSizeThreshold = m_inlinePacketSize;
+        stats.inlineJobs = m_inlineJobs.load(std::memory_order_relaxed);
+        stats.inlineParseNanos = m_inlineParseNanos.load(std::memory_order_relaxed);
+        stats.handoffNanos = m_handoffNanos.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+  private:
+    // Exponential moving average with weight 1/8 for the new sample.
+    static quint64 average(quint64 current, quint64 sample)
+    {
+        return current == 0 ? sample : current - current / 8 + sample / 8;
+    }
+
+    void sample(const std::vector<SliceWorker *> &workers)
+    {
+        const int workerCount = std::min(static_cast<int>(workers.size()), m_maxWorkers);
+        const int active = std::clamp(m_active.load(std::memory_order_relaxed), 1, workerCount);
+
+        quint64 depth = 0;
+        quint64 busyNanos = 0;
+        quint64 jobs = 0;
+        for (int i = 0; i < static_cast<int>(workers.size()); ++i)
+        {
+            const auto *worker = workers[i];
+            if (!worker)
+                continue;
+
+            const auto workerStats = worker->stats();
+            busyNanos += workerStats.busyNanos;
+            jobs += workerStats.jobs;
+            if (i < active)
+                depth += worker->queueDepth();
+        }
+        m_queueDepth.store(depth, std::memory_order_relaxed);
+
+        // Rings half full cannot wait for the end of the interval.
+        const bool flooded = depth > active * (SliceWorker::queueCapacity / 2);
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastSample).count();
+        if (elapsed < m_policy.sampleInterval.count() && !flooded)
+            return;
+
+        const auto busyDelta = busyNanos - m_lastBusyNanos;
+        const auto jobsDelta = jobs - m_lastJobs;
+        const double utilization = elapsed > 0 ? static_cast<double>(busyDelta) / static_cast<double>(elapsed) : 0.0;
+
+        m_lastSample = now;
+        m_lastBusyNanos = busyNanos;
+        m_lastJobs = jobs;
+        m_utilization.store(utilization, std::memory_order_relaxed);
+        if (jobsDelta > 0)
+            m_meanParseNanos.store(busyDelta / jobsDelta, std::memory_order_relaxed);
+
+        if (m_inlinePacketSize > 0 && m_policy.parseMode == ParseMode::Hybrid)
+            chooseParseMode();
+
+        const bool backlog = flooded || depth > active * m_policy.growQueueDepth;
+        if (active < workerCount && (backlog || utilization > active * m_policy.growUtilization))
+        {
+            m_active.store(std::min(workerCount, active + std::max(1, active / 2)), std::memory_order_relaxed);
+            m_grows.fetch_add(1, std::memory_order_relaxed);
+            m_quietIntervals = 0;
+            return;
+        }
+
+        // Depth is sampled right after a dispatch, so a burst in flight does not count against shrinking.
+        const bool quiet = !backlog && utilization < (active - 1) * m_policy.shrinkUtilization;
+        if (active > m_policy.minWorkers && quiet)
+        {
+            if (++m_quietIntervals >= m_policy.shrinkAfterIntervals)
+            {
+                m_active.store(active - 1, std::memory_order_relaxed);
+                m_shrinks.fetch_add(1, std::memory_order_relaxed);
+                m_quietIntervals = 0;
+            }
+            return;
+        }
+
+        m_quietIntervals = 0;
+    }
+
+    // Pooled parse cost comes from the workers' busy time, inline cost from timed inline dispatches.
+    void chooseParseMode()
+    {
+        const auto handoff = m_handoffNanos.load(std::memory_order_relaxed);
+        if (handoff == 0)
+            return;
+
+        if (!parseInline())
+        {
+            const auto parse = m_meanParseNanos.load(std::memory_order_relaxed);
+            if (parse > 0 && parse <= handoff * m_policy.inlineSlack)
+                m_inline.store(true, std::memory_order_relaxed);
+        }
+        else
+        {
+            // Leave some hysteresis so that noise around the limit does not flip the mode every interval.
+            const auto parse = m_inlineParseNanos.load(std::memory_order_relaxed);
+            if (parse > handoff * m_policy.inlineSlack * 1.5)
+                m_inline.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    const quint32 m_deviceId;
+    const EventPacketType m_infoType;
+    const EventPacketType m_waveType;
+    const ParserConcurrencyPolicy m_policy;
+    const int m_maxWorkers;
+    const int m_inlinePacketSize;
+
+    std::atomic<int> m_active;
+    std::atomic<bool> m_inline;
+    std::atomic<quint64> m_inlineJobs{};
+    std::atomic<quint64> m_inlineParseNanos{};
+    std::atomic<quint64> m_handoffNanos{};
+    std::atomic<quint64> m_queueDepth{};
+    std::atomic<double> m_utilization{};
+    std::atomic<quint64> m_meanParseNanos{};
+    std::atomic<quint64> m_grows{};
+    std::atomic<quint64> m_shrinks{};
+
+    // Dispatch thread only.
+    quint32 m_dispatches{};
+    int m_quietIntervals{};
+    std::chrono::steady_clock::time_point m_lastSample;
+    quint64 m_lastBusyNanos{};
+    quint64 m_lastJobs{};
+};
+
+class ParserConcurrency final
+{
+  public:
+    static ParserConcurrency &instance()
+    {
+        static ParserConcurrency concurrency;
+        return concurrency;
+    }
+
+    // Applies to pools created afterwards.
+    void setPolicy(const ParserConcurrencyPolicy &policy)
+    {
+        std::lock_guard lock(m_mutex);
+        m_policy = policy;
+    }
+
+    ParserConcurrencyPolicy policy() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_policy;
+    }
+
+    std::shared_ptr<ParserConcurrencyController> attach(quint32 deviceId, EventPacketType infoType, EventPacketType waveType, int maxWorkers,
+                                                        int inlinePacketSize = 0)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto controller = std::make_shared<ParserConcurrencyController>(deviceId, infoType, waveType, maxWorkers, m_policy, inlinePacketSize);
+        m_controllers[std::make_tuple(deviceId, infoType, waveType)] = controller;
+        return controller;
+    }
+
+    // State of every live pool; pools whose workers are gone are dropped.
+    std::vector<ParserConcurrencyStats> snapshot()
+    {
+        std::lock_guard lock(m_mutex);
+
+        std::vector<ParserConcurrencyStats> result;
+        for (auto it = m_controllers.begin(); it != m_controllers.end();)
+        {
+            if (const auto controller = it->second.lock())
+            {
+                result.push_back(controller->stats());
+                ++it;
+            }
+            else
+            {
+                it = m_controllers.erase(it);
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    mutable std::mutex m_mutex;
+    ParserConcurrencyPolicy m_policy;
+    std::map<std::tuple<quint32, EventPacketType, EventPacketType>, std::weak_ptr<ParserConcurrencyController>> m_controllers;
+};
+
+/*
+ * Round robin over the active workers of a pool. The controller is shared by
+ * all workers of the pool and reached through the first one; pools without
+ * a controller use every worker.
+ */
+inline int nextWorkerIndex(const std::vector<SliceWorker *> &workers, int &nextIndex)
+{
+    const auto *first = workers.front();
+    auto *controller = first ? first->concurrency() : nullptr;
+    const int active = controller ? controller->onDispatch(workers) : static_cast<int>(workers.size());
+
+    const int index = nextIndex % active;
+    nextIndex = (index + 1) % active;
+    return index;
+}
+
+/*
+ * Hands a valid slice of a single-type pool to the next active worker, or
+ * parses it on the calling thread when the pool runs inline. Inline parses
+ * go through the first worker, whose parser is safe to call concurrently
+ * with its own drains. submit(worker, job) queues a job on a worker, e.g.
+ * with SliceWorker::submit(); it also takes inline jobs the reorder window
+ * has no room for yet.
+ */
+template <typename Submit> void dispatchSlice(const std::vector<SliceWorker *> &workers, int &nextIndex, SliceJob &&job, Submit &&submit)
+{
+    auto *first = workers.front();
+    auto *controller = first ? first->concurrency() : nullptr;
+    if (!controller)
+    {
+        if (auto *worker = workers[nextWorkerIndex(workers, nextIndex)])
+            submit(*worker, std::move(job));
+        return;
+    }
+
+    const int active = controller->onDispatch(workers);
+    const bool inlined = controller->parseInline();
+    auto *worker = inlined ? first : workers[nextIndex % active];
+    if (!inlined)
+        nextIndex = (nextIndex % active + 1) % active;
+
+    if (!worker)
+        return;
+
+    const bool timed = controller->timeDispatch();
+    const auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+    if (inlined && worker->processInline(job))
+        controller->countInline();
+    else
+        submit(*worker, std::move(job));
+
+    if (timed)
+        controller->recordDispatch(inlined, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace network
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace network
+{
+
+/*
+ * Bounded lock-free single-producer/single-consumer ring.
+ *
+ * Capacity is rounded up to a power of two. The producer owns the tail and
+ * the consumer the head; each side caches the other's index and reloads it
+ * only when the ring looks full or empty, so an uncontended push or pop is a
+ * slot move plus one release store. Head and tail live on separate cache
+ * lines to keep the two threads from sharing one. The slots are allocated
+ * by the first push, so a ring that never carries data costs no memory.
+ */
+
+inline constexpr size_t cacheLineSize = 64;
+
+template <typename T> class SpscQueue final
+{
+  public:
+    explicit SpscQueue(size_t minimumCapacity)
+        : m_capacity(std::bit_ceil(std::max<size_t>(minimumCapacity, 2))), m_mask(m_capacity - 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    // Producer side.
+    bool tryPush(T &&value)
+    {
+        const auto tail = m_tail.value.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_capacity)
+        {
+            m_cachedHead = m_head.value.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_capacity)
+                return false;
+        }
+
+        // The consumer only touches m_slots after acquiring a tail this release publishes.
+        if (!m_slots)
+            m_slots = std::make_unique<T[]>(m_capacity);
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: whether the next tryPush() succeeds.
+    bool hasRoom()
+    {
+        const auto tail = m_tail.value.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_capacity)
+            m_cachedHead = m_head.value.load(std::memory_order_acquire);
+
+        return tail - m_cachedHead != m_capacity;
+    }
+
+    // Consumer side: moves up to maxCount items into out and returns how many were taken.
+    size_t popBatch(T *out, size_t maxCount)
+    {
+        const auto head = m_head.value.load(std::memory_order_relaxed);
+        if (m_cachedTail == head)
+        {
+            m_cachedTail = m_tail.value.load(std::memory_order_acquire);
+            if (m_cachedTail == head)
+                return 0;
+        }
+
+        const auto count = std::min<size_t>(m_cachedTail - head, maxCount);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = std::exchange(m_slots[(head + i) & m_mask], T{});
+
+        m_head.value.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Either side; exact only when the other side is idle.
+    bool isEmpty() const
+    {
+        return m_head.value.load(std::memory_order_acquire) == m_tail.value.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        return m_tail.value.load(std::memory_order_acquire) - m_head.value.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct alignas(cacheLineSize) Index
+    {
+        std::atomic<size_t> value{};
+    };
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    Index m_head;
+    alignas(cacheLineSize) size_t m_cachedTail{};
+
+    Index m_tail;
+    alignas(cacheLineSize) size_t m_cachedHead{};
+};
+
+} // namespace network
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/littleendianreader.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -28,43 +30,31 @@ namespace network
 
 struct DeviceSpectrum16
 {
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc
+        Layout::read(in, *this);
 
-            >> arrayLength >> spectrumType >> paddingLength;
-
-        for (quint32 i = 0; i < arrayLength; ++i)
-        {
-            qint16 value;
-            in >> value;
-            array.push_back(value);
-        }
+        readArray(in, array, arrayLength);
 
         in >> checksum;
-
-        for (quint16 i = 0; i < paddingLength; ++i)
-        {
-            qint16 padding;
-            in >> padding;
-        }
+        in.skipRawData(paddingLength * sizeof(qint16));
 
         return in;
     }
 
     static quint32 arrayLengthOffset()
     {
-        return offsetof(DeviceSpectrum16, arrayLength);
+        return Layout::offsetOf<&DeviceSpectrum16::arrayLength>();
     }
 
     static quint32 paddingLengthOffset()
     {
-        return offsetof(DeviceSpectrum16, paddingLength);
+        return Layout::offsetOf<&DeviceSpectrum16::paddingLength>();
     }
 
     static quint32 fixedPartSize()
     {
-        return 24;
+        return Layout::size();
     }
 
     static quint32 arrayItemSize()
@@ -84,7 +74,20 @@ struct DeviceSpectrum16
     quint16 paddingLength{};
     std::vector<qint16> array{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &DeviceSpectrum16::deviceId, 0>,
+                              WireField<"packetType", &DeviceSpectrum16::packetType, 4>,
+                              WireField<"flags", &DeviceSpectrum16::flags, 5>,
+                              WireField<"channelId", &DeviceSpectrum16::channelId, 6>,
+                              WireField<"rtc", &DeviceSpectrum16::rtc, 8>,
+                              WireField<"arrayLength", &DeviceSpectrum16::arrayLength, 16>,
+                              WireField<"spectrumType", &DeviceSpectrum16::spectrumType, 20>,
+                              WireField<"paddingLength", &DeviceSpectrum16::paddingLength, 22>>;
 };
 
+static_assert(DeviceSpectrum16::Layout::size() == 24);
+static_assert(DeviceSpectrum16::Layout::isContiguous());
+
 } // namespace network
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "packets/eventpackettype.h"
+#include "packets/wirelayout.h"
 
 #include <QObject>
 
@@ -32,19 +33,12 @@ struct PhaNetworkPacket
 {
     static size_t size()
     {
-        return 56;
+        return Layout::size();
     }
 
-    QDataStream &deserialize(QDataStream &in)
+    template <typename Stream> Stream &deserialize(Stream &in)
     {
-        in >> deviceId >> packetType >> flags >> channelId >> rtc >> trapBaseline >> trapHeightMean >> trapHeightMax >> eventCounter >> rcCr2Y1 >> rcCr2Y2;
-
-        for (auto &res : reserved)
-            in >> res;
-
-        in >> checksum;
-
-        return in;
+        return Layout::read(in, *this);
     }
 
     //[HEADER]
@@ -62,6 +56,24 @@ struct PhaNetworkPacket
     qint16 rcCr2Y2{};
     quint16 reserved[3]{};
     quint16 checksum{};
+
+    //[LAYOUT]
+    using Layout = WireLayout<WireField<"deviceId", &PhaNetworkPacket::deviceId, 0>,
+                              WireField<"packetType", &PhaNetworkPacket::packetType, 4>,
+                              WireField<"flags", &PhaNetworkPacket::flags, 5>,
+                              WireField<"channelId", &PhaNetworkPacket::channelId, 6>,
+                              WireField<"rtc", &PhaNetworkPacket::rtc, 8>,
+                              WireField<"trapBaseline", &PhaNetworkPacket::trapBaseline, 16>,
+                              WireField<"trapHeightMean", &PhaNetworkPacket::trapHeightMean, 24>,
+                              WireField<"trapHeightMax", &PhaNetworkPacket::trapHeightMax, 32>,
+                              WireField<"eventCounter", &PhaNetworkPacket::eventCounter, 40>,
+                              WireField<"rcCr2Y1", &PhaNetworkPacket::rcCr2Y1, 44>,
+                              WireField<"rcCr2Y2", &PhaNetworkPacket::rcCr2Y2, 46>,
+                              WireField<"reserved", &PhaNetworkPacket::reserved, 48>,
+                              WireField<"checksum", &PhaNetworkPacket::checksum, 54>>;
 };
 
+static_assert(PhaNetworkPacket::Layout::size() == 56);
+static_assert(PhaNetworkPacket::Layout::isContiguous());
+
 } // namespace network
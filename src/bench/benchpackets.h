@@ -0,0 +1,116 @@
+#pragma once
+
+#include "buffers/packetchecksum.h"
+#include "buffers/packetparser.h"
+#include "packets/detectronstatisticnetworkpacket.h"
+#include "packets/devicespectrum16.h"
+#include "packets/devicespectrum32.h"
+#include "packets/phanetworkpacket.h"
+#include "packets/psdnetworkpacket.h"
+#include "packets/psdnetworkpacketv2.h"
+#include "packets/waveformnetworkpacket.h"
+
+#include <QByteArray>
+#include <QtEndian>
+
+#include <random>
+#include <type_traits>
+
+/*
+ * Wire images of valid packets for the benchmarks. Field values are random;
+ * device id, packet type, rtc, lengths, padding and checksum are set so that
+ * the packets pass PacketParser validation.
+ */
+
+namespace bench
+{
+
+// The packet type each parser is configured for in the benchmarks.
+template <typename T> constexpr network::EventPacketType packetTypeOf()
+{
+    using network::EventPacketType;
+
+    if constexpr (std::is_same_v<T, network::PsdNetworkPacket>)
+        return EventPacketType::PsdEventInfo;
+    else if constexpr (std::is_same_v<T, network::PsdNetworkPacketV2>)
+        return EventPacketType::PsdEventInfoV2;
+    else if constexpr (std::is_same_v<T, network::PhaNetworkPacket>)
+        return EventPacketType::PhaEventInfo;
+    else if constexpr (std::is_same_v<T, network::WaveformNetworkPacket>)
+        return EventPacketType::PsdWaveform;
+    else if constexpr (std::is_same_v<T, network::DetectronStatisticNetworkPacket>)
+        return EventPacketType::DetectronStatisticData;
+    else if constexpr (std::is_same_v<T, network::DeviceSpectrum16>)
+        return EventPacketType::DeviceSpectrum16;
+    else if constexpr (std::is_same_v<T, network::DeviceSpectrum32>)
+        return EventPacketType::DeviceSpectrum32;
+    else
+        static_assert(sizeof(T) == 0, "no benchmark packet type for this structure");
+}
+
+inline void fillRandom(QByteArray &bytes, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    for (qsizetype i = 0; i < bytes.size(); ++i)
+        bytes.data()[i] = static_cast<char>(generator());
+}
+
+template <typename T> void writeHeader(QByteArray &bytes, quint32 deviceId, network::EventPacketType type, quint64 rtc)
+{
+    auto *data = reinterpret_cast<uchar *>(bytes.data());
+    qToLittleEndian<quint32>(deviceId, data + T::Layout::template offsetOf<&T::deviceId>());
+    qToLittleEndian<quint8>(static_cast<quint8>(type), data + T::Layout::template offsetOf<&T::packetType>());
+
+    // Statistic packets carry no timestamp; rtc only seeds their field values.
+    if constexpr (requires { &T::rtc; })
+        qToLittleEndian<quint64>(rtc, data + T::Layout::template offsetOf<&T::rtc>());
+}
+
+template <network::FixedSizeStructure T> QByteArray makePacket(quint32 deviceId, network::EventPacketType type, quint64 rtc)
+{
+    QByteArray bytes(static_cast<qsizetype>(T::size()), Qt::Uninitialized);
+    fillRandom(bytes, static_cast<unsigned>(rtc));
+    writeHeader<T>(bytes, deviceId, type, rtc);
+
+    const auto checksumOffset = bytes.size() - static_cast<qsizetype>(sizeof(quint16));
+    const auto checksum = network::calculateChecksum(QByteArrayView(bytes).first(checksumOffset));
+    qToLittleEndian<quint16>(checksum, bytes.data() + checksumOffset);
+    return bytes;
+}
+
+// Known-size packets are padded to a multiple of 8 bytes, as the device sends them.
+template <network::KnownSizeStructure T> QByteArray makePacket(quint32 deviceId, network::EventPacketType type, quint64 rtc, quint32 arrayLength)
+{
+    const qsizetype checksumOffset = T::fixedPartSize() + static_cast<qsizetype>(arrayLength) * T::arrayItemSize();
+    const qsizetype unpadded = checksumOffset + static_cast<qsizetype>(sizeof(quint16));
+    const auto paddingLength = static_cast<quint16>(((8 - unpadded % 8) % 8) / sizeof(qint16));
+
+    QByteArray bytes(unpadded + paddingLength * static_cast<qsizetype>(sizeof(qint16)), Qt::Uninitialized);
+    fillRandom(bytes, static_cast<unsigned>(rtc));
+    writeHeader<T>(bytes, deviceId, type, rtc);
+
+    auto *data = reinterpret_cast<uchar *>(bytes.data());
+    qToLittleEndian<quint32>(arrayLength, data + T::arrayLengthOffset());
+    qToLittleEndian<quint16>(paddingLength, data + T::paddingLengthOffset());
+
+    const auto checksum = network::calculateChecksum(QByteArrayView(bytes).first(checksumOffset));
+    qToLittleEndian<quint16>(checksum, data + checksumOffset);
+    return bytes;
+}
+
+// Mixed traffic: PSD event packets, a waveform behind every fourth of them and a spectrum now and then.
+inline QByteArray makeMixedStream(quint32 deviceId, int eventCount)
+{
+    QByteArray stream;
+    for (int rtc = 0; rtc < eventCount; ++rtc)
+    {
+        stream.append(makePacket<network::PsdNetworkPacket>(deviceId, network::EventPacketType::PsdEventInfo, rtc));
+        if (rtc % 4 == 0)
+            stream.append(makePacket<network::WaveformNetworkPacket>(deviceId, network::EventPacketType::PsdWaveform, rtc, 256));
+        if (rtc % 1000 == 0)
+            stream.append(makePacket<network::DeviceSpectrum16>(deviceId, network::EventPacketType::DeviceSpectrum16, rtc, 4096));
+    }
+    return stream;
+}
+
+} // namespace bench
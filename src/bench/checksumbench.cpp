@@ -0,0 +1,132 @@
+#include "buffers/packetchecksum.h"
+
+#include <QByteArray>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+/*
+ * Checksum throughput from a PSD-sized body (48 B) up to 64 KiB, for the
+ * original scalar loop and for each kernel the dispatcher can pick. Every
+ * kernel is checked against the original before it is timed.
+ */
+
+namespace
+{
+
+// The implementation calculateChecksum() replaced, kept verbatim as the reference.
+quint16 originalChecksum(const QByteArray &data)
+{
+    quint16 checksum = 0, wordsCnt = static_cast<quint16>(data.size()) / 2;
+    const auto *buff = reinterpret_cast<const quint16 *>(data.data());
+
+    for (auto it = buff; it < buff + wordsCnt; it++)
+        checksum += *it;
+
+    checksum = ~checksum;
+
+    return checksum;
+}
+
+QByteArray randomBody(qsizetype size)
+{
+    std::mt19937 generator(static_cast<unsigned>(size));
+    QByteArray body(size, Qt::Uninitialized);
+    for (qsizetype i = 0; i < size; ++i)
+        body.data()[i] = static_cast<char>(generator());
+
+    return body;
+}
+
+void setThroughput(benchmark::State &state, qsizetype size)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+
+void BM_ChecksumOriginal(benchmark::State &state)
+{
+    const auto body = randomBody(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(originalChecksum(body));
+
+    setThroughput(state, body.size());
+}
+
+void BM_ChecksumDispatched(benchmark::State &state)
+{
+    const auto body = randomBody(state.range(0));
+    if (network::calculateChecksum(body) != originalChecksum(body))
+    {
+        state.SkipWithError("checksum differs from the original");
+        return;
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(network::calculateChecksum(body));
+
+    setThroughput(state, body.size());
+}
+
+void runKernel(benchmark::State &state, network::checksum_detail::SumWordsFn kernel, bool supported)
+{
+    if (!supported)
+    {
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+
+    const auto body = randomBody(state.range(0));
+    const auto *bytes = reinterpret_cast<const uchar *>(body.constData());
+    const qsizetype words = body.size() / 2;
+
+    if (static_cast<quint16>(~kernel(bytes, words)) != originalChecksum(body))
+    {
+        state.SkipWithError("checksum differs from the original");
+        return;
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(kernel(bytes, words));
+
+    setThroughput(state, body.size());
+}
+
+void BM_ChecksumScalar(benchmark::State &state)
+{
+    runKernel(state, &network::checksum_detail::sumWordsScalar, true);
+}
+
+#if defined(NETWORK_CHECKSUM_X86) && (defined(__GNUC__) || defined(__clang__))
+
+void BM_ChecksumSse2(benchmark::State &state)
+{
+    runKernel(state, &network::checksum_detail::sumWordsSse2, __builtin_cpu_supports("sse2"));
+}
+
+void BM_ChecksumAvx2(benchmark::State &state)
+{
+    runKernel(state, &network::checksum_detail::sumWordsAvx2, __builtin_cpu_supports("avx2"));
+}
+
+void BM_ChecksumAvx512(benchmark::State &state)
+{
+    runKernel(state, &network::checksum_detail::sumWordsAvx512, __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"));
+}
+
+#endif
+
+} // namespace
+
+// 65534 is the largest body whose words are all summed; see packetchecksum.h.
+#define CHECKSUM_SIZES ->Arg(48)->Arg(56)->Arg(256)->Arg(1024)->Arg(4096)->Arg(16384)->Arg(65534)
+
+BENCHMARK(BM_ChecksumOriginal) CHECKSUM_SIZES;
+BENCHMARK(BM_ChecksumDispatched) CHECKSUM_SIZES;
+BENCHMARK(BM_ChecksumScalar) CHECKSUM_SIZES;
+
+#if defined(NETWORK_CHECKSUM_X86) && (defined(__GNUC__) || defined(__clang__))
+BENCHMARK(BM_ChecksumSse2) CHECKSUM_SIZES;
+BENCHMARK(BM_ChecksumAvx2) CHECKSUM_SIZES;
+BENCHMARK(BM_ChecksumAvx512) CHECKSUM_SIZES;
+#endif
@@ -0,0 +1,133 @@
+#include "benchpackets.h"
+
+#include "buffers/sliceparserworker.h"
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QThread>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+
+/*
+ * Per-job hand-over cost of a parser worker: slices submitted to a
+ * SliceParserWorker ring and drained by the ParserExecutor, against one
+ * queued invocation per slice on a worker QObject's thread, the way
+ * PacketParserWorker schedules processNext(). Both decode the same PSD
+ * packets with decodePacket(), so the difference is the dispatch. An
+ * iteration submits `jobs` slices and waits until the last one is parsed.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+
+QSharedPointer<QByteArray> makeSlab(int jobs)
+{
+    auto slab = QSharedPointer<QByteArray>::create();
+    for (int rtc = 0; rtc < jobs; ++rtc)
+        slab->append(bench::makePacket<network::PsdNetworkPacket>(deviceId, network::EventPacketType::PsdEventInfo, rtc));
+
+    return slab;
+}
+
+void waitFor(const std::atomic<int> &done, int jobs)
+{
+    for (auto seen = done.load(); seen < jobs; seen = done.load())
+        done.wait(seen);
+}
+
+void countDone(std::atomic<int> &done, int jobs)
+{
+    if (done.fetch_add(1) + 1 == jobs)
+        done.notify_one();
+}
+
+// QThread wants an application object on the main thread, where the benchmarks run.
+void ensureApplication()
+{
+    if (QCoreApplication::instance())
+        return;
+
+    static int argc = 1;
+    static char name[] = "digitizer-bench";
+    static char *argv[] = {name, nullptr};
+    static QCoreApplication application(argc, argv);
+}
+
+void BM_SliceWorkerDispatch(benchmark::State &state)
+{
+    const auto jobs = static_cast<int>(state.range(0));
+    const auto slab = makeSlab(jobs);
+    const auto packetSize = static_cast<int>(network::PsdNetworkPacket::size());
+
+    auto parser = std::make_unique<network::PacketParser<network::PsdNetworkPacket>>(network::EventPacketType::PsdEventInfo);
+    parser->setDeviceId(deviceId);
+    network::SliceParserWorker<network::PsdNetworkPacket> worker(std::move(parser));
+
+    std::atomic<int> done{0};
+    worker.setResultHandler([&done, jobs](network::ParsedSlice &slice) {
+        benchmark::DoNotOptimize(slice.emissions[0].packet);
+        countDone(done, jobs);
+    });
+
+    for (auto _ : state)
+    {
+        done = 0;
+        for (int job = 0; job < jobs; ++job)
+            worker.enqueueSlice(slab, job * packetSize, packetSize);
+
+        waitFor(done, jobs);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * jobs);
+}
+
+void BM_QueuedConnectionDispatch(benchmark::State &state)
+{
+    ensureApplication();
+
+    const auto jobs = static_cast<int>(state.range(0));
+    const auto slab = makeSlab(jobs);
+    const auto packetSize = static_cast<int>(network::PsdNetworkPacket::size());
+
+    network::PacketParser<network::PsdNetworkPacket> parser(network::EventPacketType::PsdEventInfo);
+    parser.setDeviceId(deviceId);
+
+    QThread thread;
+    QObject receiver;
+    receiver.moveToThread(&thread);
+    thread.start();
+
+    std::atomic<int> done{0};
+    for (auto _ : state)
+    {
+        done = 0;
+        for (int job = 0; job < jobs; ++job)
+        {
+            const QByteArrayView view(slab->constData() + job * packetSize, packetSize);
+            QMetaObject::invokeMethod(
+                &receiver,
+                [&parser, &done, view, jobs] {
+                    benchmark::DoNotOptimize(parser.decodePacket(view));
+                    countDone(done, jobs);
+                },
+                Qt::QueuedConnection);
+        }
+
+        waitFor(done, jobs);
+    }
+
+    thread.quit();
+    thread.wait();
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * jobs);
+}
+
+} // namespace
+
+BENCHMARK(BM_SliceWorkerDispatch)->Arg(1024)->Arg(16384)->ArgName("jobs")->UseRealTime();
+BENCHMARK(BM_QueuedConnectionDispatch)->Arg(1024)->Arg(16384)->ArgName("jobs")->UseRealTime();
@@ -0,0 +1,275 @@
+#include "benchpackets.h"
+
+#include "buffers/ioreactorgroup.h"
+#include "buffers/iouringingest.h"
+#include "buffers/receivepipeline.h"
+
+#include <QCoreApplication>
+#include <QTcpSocket>
+
+#include <benchmark/benchmark.h>
+
+#ifdef Q_OS_LINUX
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * Device data over loopback TCP into a ReceivePipeline, by ingest backend:
+ * a QTcpSocket read with readFrom() after every readyRead, as on the
+ * NetworkWorker thread, against an IoUringIngest the socket was handed to
+ * with adoptSocket(). A writer thread sends the mixed stream in 64 KiB
+ * writes and closes the connection; an iteration ends when the pipeline
+ * has delivered everything. wakeupsPerMiB counts readyRead waits for Qt and
+ * io_uring_enter() calls for io_uring. io_uring iterations are skipped
+ * where the kernel does not offer it.
+ *
+ * BM_ReactorScaling streams to several devices at once, each with its own
+ * connection and pipeline, whose sockets an IoReactorGroup of the given
+ * size shares out. Aggregate throughput should grow with the reactor count
+ * until the framing and parser threads saturate the cores.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int writeSize = 64 * 1024;
+constexpr double mebibyte = 1024.0 * 1024.0;
+
+enum class Backend
+{
+    Qt,
+    IoUring
+};
+
+struct Loopback
+{
+    int reader{-1};
+    int writer{-1};
+};
+
+Loopback connectLoopback()
+{
+    Loopback loopback;
+
+    const int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+
+    if (listener >= 0 && ::bind(listener, reinterpret_cast<sockaddr *>(&address), length) == 0 && ::listen(listener, 1) == 0 &&
+        ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) == 0)
+    {
+        loopback.writer = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (loopback.writer >= 0 && ::connect(loopback.writer, reinterpret_cast<sockaddr *>(&address), length) == 0)
+            loopback.reader = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    }
+
+    if (listener >= 0)
+        ::close(listener);
+
+    return loopback;
+}
+
+std::thread sendAll(int descriptor, QByteArrayView bytes)
+{
+    return std::thread([descriptor, bytes] {
+        for (qsizetype offset = 0; offset < bytes.size();)
+        {
+            const auto sent = ::send(descriptor, bytes.constData() + offset, static_cast<size_t>(std::min<qsizetype>(writeSize, bytes.size() - offset)), 0);
+            if (sent <= 0)
+                break;
+
+            offset += sent;
+        }
+
+        ::close(descriptor);
+    });
+}
+
+// QTcpSocket wants an application object on the main thread, where the benchmarks run.
+void ensureApplication()
+{
+    if (QCoreApplication::instance())
+        return;
+
+    static int argc = 1;
+    static char name[] = "digitizer-bench";
+    static char *argv[] = {name, nullptr};
+    static QCoreApplication application(argc, argv);
+}
+
+void BM_LoopbackIngest(benchmark::State &state)
+{
+    ensureApplication();
+
+    const auto backend = static_cast<Backend>(state.range(0));
+    const auto stream = bench::makeMixedStream(deviceId, static_cast<int>(state.range(1)));
+
+    const auto ingest = backend == Backend::IoUring ? network::IoUringIngest::create() : nullptr;
+    if (backend == Backend::IoUring && !ingest)
+    {
+        state.SkipWithError("io_uring not available");
+        return;
+    }
+
+    quint64 delivered = 0;
+    quint64 wakeups = 0;
+
+    for (auto _ : state)
+    {
+        const auto loopback = connectLoopback();
+        if (loopback.reader < 0)
+        {
+            state.SkipWithError("loopback connection failed");
+            return;
+        }
+
+        network::ReceivePipeline pipeline(deviceId);
+        pipeline.addParser<network::PsdNetworkPacket>(network::EventPacketType::PsdEventInfo);
+        pipeline.addParser<network::WaveformNetworkPacket>(network::EventPacketType::PsdWaveform);
+        pipeline.addParser<network::DeviceSpectrum16>(network::EventPacketType::DeviceSpectrum16);
+        pipeline.setBatchCallback([](const network::NetworkPacketBatch &batch) { benchmark::DoNotOptimize(batch.data()); });
+        pipeline.start();
+
+        auto writer = sendAll(loopback.writer, stream);
+
+        if (backend == Backend::Qt)
+        {
+            QTcpSocket socket;
+            socket.setSocketDescriptor(loopback.reader);
+            while (socket.waitForReadyRead(-1))
+            {
+                pipeline.readFrom(&socket);
+                ++wakeups;
+            }
+
+            pipeline.readFrom(&socket);
+        }
+        else
+        {
+            const auto enterCalls = ingest->stats().enterCalls;
+
+            std::promise<void> closed;
+            const bool adopted = pipeline.adoptSocket(*ingest, loopback.reader, [&closed](int error) {
+                Q_UNUSED(error)
+                closed.set_value();
+            });
+            if (!adopted)
+            {
+                // Still ours; closing it ends the writer's sends.
+                ::close(loopback.reader);
+                writer.join();
+                pipeline.stop();
+                state.SkipWithError("io_uring refused the socket");
+                return;
+            }
+            closed.get_future().wait();
+
+            wakeups += ingest->stats().enterCalls - enterCalls;
+        }
+
+        writer.join();
+        pipeline.stop();
+        delivered = pipeline.stats().deliveredPackets;
+    }
+
+    const auto bytes = static_cast<double>(state.iterations()) * static_cast<double>(stream.size());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * delivered));
+    state.counters["wakeupsPerMiB"] = static_cast<double>(wakeups) / (bytes / mebibyte);
+}
+
+void BM_ReactorScaling(benchmark::State &state)
+{
+    ensureApplication();
+
+    const auto deviceCount = static_cast<int>(state.range(1));
+
+    std::vector<QByteArray> streams;
+    qint64 streamBytes = 0;
+    for (int device = 0; device < deviceCount; ++device)
+    {
+        streams.push_back(bench::makeMixedStream(deviceId + static_cast<quint32>(device), static_cast<int>(state.range(2))));
+        streamBytes += streams.back().size();
+    }
+
+    network::IoReactorPolicy policy;
+    policy.reactorCount = static_cast<int>(state.range(0));
+    policy.preferIoUring = state.range(3) != 0;
+    network::IoReactorGroup group(policy);
+
+    for (auto _ : state)
+    {
+        std::vector<std::unique_ptr<network::ReceivePipeline>> pipelines;
+        std::vector<std::promise<void>> closed(deviceCount);
+        std::vector<std::thread> writers;
+
+        for (int device = 0; device < deviceCount; ++device)
+        {
+            const auto loopback = connectLoopback();
+            if (loopback.reader < 0)
+            {
+                state.SkipWithError("loopback connection failed");
+                break;
+            }
+
+            auto &pipeline = *pipelines.emplace_back(std::make_unique<network::ReceivePipeline>(deviceId + static_cast<quint32>(device)));
+            pipeline.addParser<network::PsdNetworkPacket>(network::EventPacketType::PsdEventInfo);
+            pipeline.addParser<network::WaveformNetworkPacket>(network::EventPacketType::PsdWaveform);
+            pipeline.addParser<network::DeviceSpectrum16>(network::EventPacketType::DeviceSpectrum16);
+            pipeline.setBatchCallback([](const network::NetworkPacketBatch &batch) { benchmark::DoNotOptimize(batch.data()); });
+            pipeline.start();
+
+            const auto reactor = pipeline.adoptSocket(group, loopback.reader, [&promise = closed[device]](int error) {
+                Q_UNUSED(error)
+                promise.set_value();
+            });
+            if (reactor < 0)
+            {
+                ::close(loopback.reader);
+                ::close(loopback.writer);
+                state.SkipWithError("reactor refused the socket");
+                break;
+            }
+
+            writers.push_back(sendAll(loopback.writer, streams[device]));
+        }
+
+        for (size_t device = 0; device < writers.size(); ++device)
+        {
+            closed[device].get_future().wait();
+            writers[device].join();
+        }
+
+        for (auto &pipeline : pipelines)
+            pipeline->stop();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * streamBytes);
+}
+
+} // namespace
+
+BENCHMARK(BM_LoopbackIngest)
+    ->ArgsProduct({{static_cast<int>(Backend::Qt), static_cast<int>(Backend::IoUring)}, {100000}})
+    ->ArgNames({"backend", "events"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_ReactorScaling)
+    ->ArgsProduct({{1, 2, 4, 8}, {8, 32}, {10000}, {0, 1}})
+    ->ArgNames({"reactors", "devices", "events", "ioUring"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+#endif
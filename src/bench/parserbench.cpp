@@ -0,0 +1,76 @@
+#include "benchpackets.h"
+
+#include <benchmark/benchmark.h>
+
+/*
+ * Per-type decode cost: parsePacket(), the path libnetworker was compiled
+ * with (copy into a QByteArray, QDataStream), against decodePacket(), which
+ * validates and decodes straight from the receive view. Both are checked to
+ * accept the packet before they are timed.
+ */
+
+namespace
+{
+
+template <typename T> QByteArray packetFor(benchmark::State &state)
+{
+    if constexpr (network::FixedSizeStructure<T>)
+        return bench::makePacket<T>(1, bench::packetTypeOf<T>(), 42);
+    else
+        return bench::makePacket<T>(1, bench::packetTypeOf<T>(), 42, static_cast<quint32>(state.range(0)));
+}
+
+template <typename T> void BM_ParsePacket(benchmark::State &state)
+{
+    network::PacketParser<T> parser(bench::packetTypeOf<T>());
+    parser.setDeviceId(1);
+
+    const auto packet = packetFor<T>(state);
+    if (!parser.parsePacket(packet))
+    {
+        state.SkipWithError("packet rejected");
+        return;
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(parser.parsePacket(packet));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * packet.size());
+}
+
+template <typename T> void BM_DecodePacket(benchmark::State &state)
+{
+    network::PacketParser<T> parser(bench::packetTypeOf<T>());
+    parser.setDeviceId(1);
+
+    const auto packet = packetFor<T>(state);
+    if (!parser.decodePacket(packet))
+    {
+        state.SkipWithError("packet rejected");
+        return;
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(parser.decodePacket(packet));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * packet.size());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::PsdNetworkPacket);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::PsdNetworkPacket);
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::PsdNetworkPacketV2);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::PsdNetworkPacketV2);
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::PhaNetworkPacket);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::PhaNetworkPacket);
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::DetectronStatisticNetworkPacket);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::DetectronStatisticNetworkPacket);
+
+// Arguments are sample or bin counts.
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::WaveformNetworkPacket)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::WaveformNetworkPacket)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::DeviceSpectrum16)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::DeviceSpectrum16)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_ParsePacket, network::DeviceSpectrum32)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_DecodePacket, network::DeviceSpectrum32)->Arg(4096);
@@ -0,0 +1,68 @@
+#include "benchpackets.h"
+
+#include "buffers/networkpacket.h"
+#include "buffers/payloadpool.h"
+#include "packetwrappers/eventvalue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+/*
+ * Waveform events with their samples on the heap against samples from the
+ * device's PayloadPool. Packets of varying length are converted with
+ * toEventValue() as ReceivePipeline delivers them; the consumer keeps the
+ * last inFlight events, so every conversion also releases an older event's
+ * samples. upstreamMiB is what the pool holds from the heap at the end: it
+ * stays at the working set however long the run.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int packetCount = 1024;
+
+network::NetworkPacketBatch makeWaveforms(int maxSamples)
+{
+    network::PacketParser<network::WaveformNetworkPacket> parser(network::EventPacketType::PsdWaveform);
+    parser.setDeviceId(deviceId);
+
+    network::NetworkPacketBatch packets;
+    for (int rtc = 0; rtc < packetCount; ++rtc)
+    {
+        const auto samples = static_cast<quint32>(16 + (rtc * 37) % maxSamples);
+        auto packet = parser.parsePacket(bench::makePacket<network::WaveformNetworkPacket>(deviceId, network::EventPacketType::PsdWaveform, rtc, samples));
+        if (packet)
+            packets.emplace_back(std::move(packet->first));
+    }
+
+    return packets;
+}
+
+void BM_WaveformEvents(benchmark::State &state)
+{
+    const bool pooled = state.range(0) != 0;
+    const auto packets = makeWaveforms(static_cast<int>(state.range(1)));
+    const auto pool = pooled ? network::PayloadPools::instance().attach(deviceId) : nullptr;
+
+    std::vector<std::optional<network::EventValue>> inFlight(static_cast<size_t>(state.range(2)));
+    size_t next = 0;
+
+    for (auto _ : state)
+    {
+        for (const auto &packet : packets)
+        {
+            inFlight[next] = network::toEventValue(packet, pool.get());
+            next = (next + 1) % inFlight.size();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(packets.size()));
+    if (pool)
+        state.counters["upstreamMiB"] = static_cast<double>(pool->stats().upstreamBytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+BENCHMARK(BM_WaveformEvents)->ArgsProduct({{0, 1}, {512, 8192}, {256, 16384}})->ArgNames({"pooled", "maxSamples", "inFlight"});
@@ -0,0 +1,73 @@
+#include "benchpackets.h"
+
+#include "buffers/parserconcurrency.h"
+#include "buffers/receivepipeline.h"
+
+#include <benchmark/benchmark.h>
+
+/*
+ * ReceivePipeline on mixed traffic, by ParseMode: PSD event packets (48
+ * bytes, inline-eligible) with a waveform behind every fourth of them and a
+ * spectrum now and then. Each iteration feeds the whole stream in 64 KiB
+ * reads and stops the pipeline once everything was delivered, so the time
+ * covers framing, parsing and the reorder window. inlineShare is the share
+ * of PSD packets the framing thread parsed itself.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int chunkSize = 64 * 1024;
+
+void BM_PipelineParseMode(benchmark::State &state)
+{
+    const auto mode = static_cast<network::ParseMode>(state.range(0));
+    const auto stream = bench::makeMixedStream(deviceId, static_cast<int>(state.range(1)));
+    const QByteArrayView bytes(stream);
+
+    network::ParserConcurrencyPolicy policy;
+    policy.parseMode = mode;
+    network::ParserConcurrency::instance().setPolicy(policy);
+
+    quint64 delivered = 0;
+    double inlineShare = 0.0;
+
+    for (auto _ : state)
+    {
+        network::ReceivePipeline pipeline(deviceId);
+        pipeline.addParser<network::PsdNetworkPacket>(network::EventPacketType::PsdEventInfo);
+        pipeline.addParser<network::WaveformNetworkPacket>(network::EventPacketType::PsdWaveform);
+        pipeline.addParser<network::DeviceSpectrum16>(network::EventPacketType::DeviceSpectrum16);
+        pipeline.setBatchCallback([](const network::NetworkPacketBatch &batch) { benchmark::DoNotOptimize(batch.data()); });
+        pipeline.start();
+
+        for (qsizetype offset = 0; offset < bytes.size(); offset += chunkSize)
+            pipeline.append(bytes.sliced(offset, std::min<qsizetype>(chunkSize, bytes.size() - offset)));
+
+        pipeline.stop();
+        delivered = pipeline.stats().deliveredPackets;
+
+        // The controllers live as long as the pipeline.
+        for (const auto &pool : network::ParserConcurrency::instance().snapshot())
+        {
+            if (pool.deviceId == deviceId && pool.infoType == network::EventPacketType::PsdEventInfo)
+                inlineShare = static_cast<double>(pool.inlineJobs) / static_cast<double>(state.range(1));
+        }
+    }
+
+    network::ParserConcurrency::instance().setPolicy({});
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * delivered));
+    state.counters["inlineShare"] = inlineShare;
+}
+
+} // namespace
+
+BENCHMARK(BM_PipelineParseMode)
+    ->ArgsProduct({{static_cast<int>(network::ParseMode::Pooled), static_cast<int>(network::ParseMode::Inline), static_cast<int>(network::ParseMode::Hybrid)},
+                   {100000}})
+    ->ArgNames({"mode", "events"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
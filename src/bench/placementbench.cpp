@@ -0,0 +1,88 @@
+#include "benchpackets.h"
+
+#include "buffers/receivepipeline.h"
+#include "buffers/threadplacement.h"
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+/*
+ * ReceivePipeline throughput with the ThreadPlacement policy off and on.
+ * With it on, node 0 takes the pipeline: the reading thread (a thread of
+ * its own that feeds the mixed stream in 64 KiB reads, like an I/O reactor)
+ * and the framing thread are pinned to its reserved cores, and new receive
+ * slabs are bound to its memory. The ParserExecutor is sized and pinned
+ * when it first starts, so parser placement follows whichever run started
+ * it; run the two cases in separate processes to compare that as well.
+ * Skipped where the machine has a single NUMA node, since there is nothing
+ * to place.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int chunkSize = 64 * 1024;
+constexpr int maxProbedNodes = 64;
+
+int numaNodeCount()
+{
+    int nodes = 0;
+    for (int node = 0; node < maxProbedNodes; ++node)
+        nodes += network::ThreadPlacement::cpusOfNode(node).empty() ? 0 : 1;
+
+    return nodes;
+}
+
+void BM_PipelinePlacement(benchmark::State &state)
+{
+    if (numaNodeCount() < 2)
+    {
+        state.SkipWithError("single NUMA node");
+        return;
+    }
+
+    const bool placed = state.range(0) != 0;
+    const auto stream = bench::makeMixedStream(deviceId, static_cast<int>(state.range(1)));
+    const QByteArrayView bytes(stream);
+
+    network::ThreadPlacementPolicy policy;
+    policy.enabled = placed;
+    policy.numaNode = 0;
+    network::ThreadPlacement::instance().setPolicy(policy);
+
+    quint64 delivered = 0;
+
+    for (auto _ : state)
+    {
+        network::ReceivePipeline pipeline(deviceId);
+        pipeline.addParser<network::PsdNetworkPacket>(network::EventPacketType::PsdEventInfo);
+        pipeline.addParser<network::WaveformNetworkPacket>(network::EventPacketType::PsdWaveform);
+        pipeline.addParser<network::DeviceSpectrum16>(network::EventPacketType::DeviceSpectrum16);
+        pipeline.setBatchCallback([](const network::NetworkPacketBatch &batch) { benchmark::DoNotOptimize(batch.data()); });
+        pipeline.start();
+
+        std::thread reader([&pipeline, bytes] {
+            network::ThreadPlacement::instance().pinCurrentThread(network::ThreadRole::Io);
+            for (qsizetype offset = 0; offset < bytes.size(); offset += chunkSize)
+                pipeline.append(bytes.sliced(offset, std::min<qsizetype>(chunkSize, bytes.size() - offset)));
+        });
+        reader.join();
+
+        pipeline.stop();
+        delivered = pipeline.stats().deliveredPackets;
+    }
+
+    const auto placement = network::ThreadPlacement::instance().stats();
+    network::ThreadPlacement::instance().setPolicy({});
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * delivered));
+    state.counters["boundMiB"] = static_cast<double>(placement.boundBytes) / (1024.0 * 1024.0);
+    state.counters["placementFailures"] = static_cast<double>(placement.failures);
+}
+
+} // namespace
+
+BENCHMARK(BM_PipelinePlacement)->ArgsProduct({{0, 1}, {100000}})->ArgNames({"placed", "events"})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,165 @@
+#include "benchpackets.h"
+
+#include "buffers/framingstage.h"
+#include "buffers/slabpool.h"
+#include "buffers/streamresync.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+ * Framing of a corrupted stream: a mix of PSD event and waveform packets in
+ * which a share of the packets gets a bit flipped anywhere in its bytes or
+ * loses a random part of its tail. FramingStage resynchronizes after every
+ * broken header. Counters:
+ *  - recovered: share of the intact packets that were framed and pass the
+ *    checksum,
+ *  - resyncs: broken headers per stream,
+ *  - skippedPerResync: bytes lost between a broken header and the next
+ *    packet framing resumed at,
+ *  - resyncLatencyUs: mean time from pushing the chunk that holds a
+ *    corrupted packet to the first intact packet after it being framed.
+ * Arguments are the flip and truncation rates in packets per thousand and
+ * the maximum packet size framing accepts. A corrupted length field below
+ * that limit holds up framing until that many bytes arrived, so the limit
+ * should follow the largest packet the device sends (here about 1 KiB).
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int packetCount = 20000;
+constexpr int chunkSize = 64 * 1024;
+
+struct CorruptedStream
+{
+    QByteArray bytes;
+    std::vector<bool> intact; // by rtc
+    int intactCount{};
+    std::vector<std::pair<qsizetype, int>> corrupted; // offset and rtc of each damaged packet
+};
+
+struct Corruption
+{
+    int rtc{};
+    std::chrono::steady_clock::time_point pushed;
+};
+
+CorruptedStream makeStream(int flipsPerMille, int truncationsPerMille)
+{
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> perMille(0, 999);
+
+    CorruptedStream stream;
+    stream.intact.resize(packetCount);
+
+    for (int rtc = 0; rtc < packetCount; ++rtc)
+    {
+        auto packet = rtc % 2 ? bench::makePacket<network::PsdNetworkPacket>(deviceId, network::EventPacketType::PsdEventInfo, rtc)
+                              : bench::makePacket<network::WaveformNetworkPacket>(deviceId, network::EventPacketType::PsdWaveform, rtc, 16 + rtc % 500);
+
+        bool intact = true;
+        if (perMille(generator) < flipsPerMille)
+        {
+            const auto bit = std::uniform_int_distribution<qsizetype>(0, packet.size() * 8 - 1)(generator);
+            packet.data()[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            intact = false;
+        }
+
+        if (perMille(generator) < truncationsPerMille)
+        {
+            packet.truncate(std::uniform_int_distribution<qsizetype>(1, packet.size() - 1)(generator));
+            intact = false;
+        }
+
+        stream.intact[rtc] = intact;
+        stream.intactCount += intact ? 1 : 0;
+        if (!intact)
+            stream.corrupted.emplace_back(stream.bytes.size(), rtc);
+        stream.bytes.append(packet);
+    }
+
+    return stream;
+}
+
+void BM_FramingResync(benchmark::State &state)
+{
+    const auto stream = makeStream(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const network::StreamResync validator(deviceId);
+    const QByteArrayView bytes(stream.bytes);
+
+    int recovered = 0;
+    network::FramingStats framing;
+    std::chrono::nanoseconds latency{};
+    int latencySamples = 0;
+
+    for (auto _ : state)
+    {
+        auto slabs = network::SlabPool::create();
+        network::FramingStage stage(deviceId);
+        stage.setMaxPacketSize(static_cast<int>(state.range(2)));
+        std::vector<bool> seen(packetCount);
+        recovered = 0;
+        latency = {};
+        latencySamples = 0;
+
+        // Corruptions in chunks pushed so far that no intact packet was framed behind yet.
+        std::deque<Corruption> unresolved;
+        size_t nextCorruption = 0;
+
+        const auto dispatch = [&](const QSharedPointer<QByteArray> &buffer, const network::SliceIndex &index) {
+            for (const auto &slice : index.slices)
+            {
+                if (slice.rtc >= static_cast<quint64>(packetCount) || !stream.intact[slice.rtc] || seen[slice.rtc])
+                    continue;
+
+                if (validator.validateAt(QByteArrayView(buffer->constData(), slice.offset + slice.length), slice.offset))
+                {
+                    seen[slice.rtc] = true;
+                    ++recovered;
+
+                    if (!unresolved.empty() && std::cmp_less(unresolved.front().rtc, slice.rtc))
+                    {
+                        const auto now = std::chrono::steady_clock::now();
+                        for (; !unresolved.empty() && std::cmp_less(unresolved.front().rtc, slice.rtc); unresolved.pop_front(), ++latencySamples)
+                            latency += now - unresolved.front().pushed;
+                    }
+                }
+            }
+        };
+
+        for (qsizetype offset = 0; offset < bytes.size(); offset += chunkSize)
+        {
+            if (nextCorruption < stream.corrupted.size() && stream.corrupted[nextCorruption].first < offset + chunkSize)
+            {
+                const auto pushed = std::chrono::steady_clock::now();
+                for (; nextCorruption < stream.corrupted.size() && stream.corrupted[nextCorruption].first < offset + chunkSize; ++nextCorruption)
+                    unresolved.push_back({stream.corrupted[nextCorruption].second, pushed});
+            }
+
+            network::SlabPool::Chunk chunk;
+            slabs->append(bytes.sliced(offset, std::min<qsizetype>(chunkSize, bytes.size() - offset)), chunk);
+            stage.push(chunk, dispatch);
+        }
+
+        framing = stage.stats();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes.size());
+    state.counters["recovered"] = static_cast<double>(recovered) / stream.intactCount;
+    state.counters["resyncs"] = static_cast<double>(framing.resyncs);
+    state.counters["skippedPerResync"] = framing.resyncs ? static_cast<double>(framing.discardedBytes) / framing.resyncs : 0.0;
+    state.counters["resyncLatencyUs"] = latencySamples ? std::chrono::duration<double, std::micro>(latency).count() / latencySamples : 0.0;
+}
+
+} // namespace
+
+BENCHMARK(BM_FramingResync)
+    ->ArgsProduct({{0, 1, 10, 50}, {0, 1, 10, 50}, {64 * 1024, 4 * 1024 * 1024}})
+    ->ArgNames({"flips", "truncations", "maxPacketSize"})
+    ->Unit(benchmark::kMillisecond);
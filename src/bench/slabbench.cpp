@@ -0,0 +1,102 @@
+#include "benchpackets.h"
+
+#include "buffers/slabpool.h"
+
+#include <QIODevice>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+
+/*
+ * Socket reads into a fresh QByteArray per readyRead, as
+ * PacketBuffer::processData() does, against SlabPool::readFrom() into
+ * pooled slabs, as ReceivePipeline does. The device makes one chunk of the
+ * given size readable per iteration; chunks are released right after the
+ * read, as they would be once parsed. slabAllocationsPerChunk counts the
+ * slabs the pool had to allocate rather than reuse.
+ */
+
+namespace
+{
+
+// A socket stand-in that makes one chunk readable per receive().
+class ChunkedDevice final : public QIODevice
+{
+  public:
+    explicit ChunkedDevice(qsizetype chunkSize) : m_chunk(chunkSize, Qt::Uninitialized)
+    {
+        bench::fillRandom(m_chunk, 1);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    void receive()
+    {
+        m_available = m_chunk.size();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_available + QIODevice::bytesAvailable();
+    }
+
+  protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const auto bytes = std::min<qint64>(maxSize, m_available);
+        std::memcpy(data, m_chunk.constData() + (m_chunk.size() - m_available), static_cast<size_t>(bytes));
+        m_available -= bytes;
+        return bytes;
+    }
+
+    qint64 writeData(const char *data, qint64 maxSize) override
+    {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+
+  private:
+    QByteArray m_chunk;
+    qint64 m_available{};
+};
+
+void BM_ReadAll(benchmark::State &state)
+{
+    ChunkedDevice device(state.range(0));
+
+    for (auto _ : state)
+    {
+        device.receive();
+        const auto chunk = device.readAll();
+        benchmark::DoNotOptimize(chunk.constData());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_SlabReadFrom(benchmark::State &state)
+{
+    ChunkedDevice device(state.range(0));
+    auto slabs = network::SlabPool::create();
+
+    for (auto _ : state)
+    {
+        device.receive();
+        slabs->readFrom(&device, [](network::SlabPool::Chunk chunk) { benchmark::DoNotOptimize(chunk.bytes().data()); });
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["slabAllocationsPerChunk"] = static_cast<double>(slabs->slabsAllocated()) / static_cast<double>(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_ReadAll)->RangeMultiplier(4)->Range(1024, 256 * 1024)->ArgName("chunkSize");
+BENCHMARK(BM_SlabReadFrom)->RangeMultiplier(4)->Range(1024, 256 * 1024)->ArgName("chunkSize");
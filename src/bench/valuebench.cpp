@@ -0,0 +1,118 @@
+#include "benchpackets.h"
+
+#include "buffers/eventvaluesink.h"
+#include "buffers/networkpacket.h"
+#include "packetwrappers/eventdata.h"
+#include "packetwrappers/eventpacket.h"
+
+#include <QSharedPointer>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+/*
+ * Per-event cost of the two delivery paths for one parsed batch: QObject
+ * event packets paired into EventData and read back with qobject_cast, as
+ * the example's DataWorker does, against EventValueSink's EventRecords read
+ * with std::get_if. Batches hold PSD events, each followed by its waveform
+ * when waveforms is set. Both consumers touch the same fields, so the
+ * difference is the cost of creating and dispatching the events.
+ */
+
+namespace
+{
+
+constexpr quint32 deviceId = 1;
+constexpr int eventCount = 4096;
+
+template <typename T, typename... Args> T parsed(Args... args)
+{
+    network::PacketParser<T> parser(bench::packetTypeOf<T>());
+    parser.setDeviceId(deviceId);
+    return parser.parsePacket(bench::makePacket<T>(deviceId, bench::packetTypeOf<T>(), args...))->first;
+}
+
+network::NetworkPacketBatch makeBatch(bool withWaveforms)
+{
+    network::NetworkPacketBatch batch;
+    for (int rtc = 0; rtc < eventCount; ++rtc)
+    {
+        batch.emplace_back(parsed<network::PsdNetworkPacket>(rtc));
+        if (withWaveforms)
+            batch.emplace_back(parsed<network::WaveformNetworkPacket>(rtc, 256u));
+    }
+
+    return batch;
+}
+
+// What PacketBuffer and the parser workers hand to EventData consumers.
+std::vector<network::EventData> toEventData(const network::NetworkPacketBatch &batch)
+{
+    std::vector<network::EventData> events;
+    for (const auto &packet : batch)
+    {
+        if (const auto *psd = std::get_if<network::PsdNetworkPacket>(&packet))
+        {
+            events.push_back({QSharedPointer<network::PsdEventPacket>::create(*psd), nullptr});
+        }
+        else if (const auto *waveform = std::get_if<network::WaveformNetworkPacket>(&packet))
+        {
+            auto event = QSharedPointer<network::WaveformEventPacket>::create(*waveform);
+            if (!events.empty() && events.back().infoPacket && !events.back().waveformPacket && events.back().infoPacket->header().rtc == waveform->rtc)
+                events.back().waveformPacket = event;
+            else
+                events.push_back({nullptr, event});
+        }
+    }
+
+    return events;
+}
+
+void BM_QObjectEvents(benchmark::State &state)
+{
+    const auto batch = makeBatch(state.range(0) != 0);
+    qint64 sum = 0;
+
+    for (auto _ : state)
+    {
+        for (const auto &event : toEventData(batch))
+        {
+            if (const auto *psd = qobject_cast<const network::PsdEventPacket *>(event.infoPacket.data()))
+                sum += psd->m_qLong;
+            if (const auto *waveform = qobject_cast<const network::WaveformEventPacket *>(event.waveformPacket.data()))
+                sum += waveform->m_waveform.front();
+        }
+    }
+
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * eventCount);
+}
+
+void BM_ValueEvents(benchmark::State &state)
+{
+    const auto batch = makeBatch(state.range(0) != 0);
+    qint64 sum = 0;
+
+    network::EventValueSink sink;
+    sink.setBatchCallback([&sum](std::span<const network::EventRecord> records) {
+        for (const auto &record : records)
+        {
+            if (const auto *psd = std::get_if<network::PsdEvent>(&record.info))
+                sum += psd->qLong;
+            if (record.waveform)
+                sum += record.waveform->samples->front();
+        }
+    });
+
+    for (auto _ : state)
+        sink.deliver(batch);
+
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * eventCount);
+}
+
+} // namespace
+
+BENCHMARK(BM_QObjectEvents)->Arg(0)->Arg(1)->ArgName("waveforms");
+BENCHMARK(BM_ValueEvents)->Arg(0)->Arg(1)->ArgName("waveforms");